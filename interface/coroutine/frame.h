@@ -40,10 +40,21 @@
 #include <exception>  // std::current_exception
 #include <functional> // std::hash
 
+#include <coroutine/trace.h>
+
 #if defined(__cpp_coroutines)
 // ...
 #endif
 
+// With `USE_INLINE_COROUTINE_HANDLE`, `coroutine_handle` uses the compiler's
+// `__builtin_coro_*` at the call site instead of calling `portable_coro_*`.
+// Clang/GCC only. MSVC always goes through the `coroutine_portable` module.
+#if defined(USE_INLINE_COROUTINE_HANDLE)
+#if defined(_MSC_VER) && !defined(__clang__)
+#undef USE_INLINE_COROUTINE_HANDLE
+#endif
+#endif
+
 struct portable_coro_prefix;
 
 bool portable_coro_done(portable_coro_prefix* _Handle);
@@ -88,6 +99,24 @@ struct coroutine_handle<void> {
     constexpr explicit operator bool() const noexcept {
         return _Ptr != nullptr;
     }
+#if defined(USE_INLINE_COROUTINE_HANDLE)
+    bool done() const {
+        return __builtin_coro_done(_Ptr);
+    }
+    // 17.12.3.4, resumption
+    void resume() const {
+        COROUTINE_TRACE_POINT(resume_begin, _Ptr);
+        __builtin_coro_resume(_Ptr);
+        COROUTINE_TRACE_POINT(resume_end, _Ptr);
+    }
+    void operator()() const {
+        return resume();
+    }
+    void destroy() const {
+        COROUTINE_TRACE_POINT(destroy, _Ptr);
+        __builtin_coro_destroy(_Ptr);
+    }
+#else
     bool done() const {
         return portable_coro_done(_Ptr);
     }
@@ -101,6 +130,7 @@ struct coroutine_handle<void> {
     void destroy() const {
         return portable_coro_destroy(_Ptr);
     }
+#endif
 
   protected: // this is `private` in the standard
     portable_coro_prefix* _Ptr = nullptr;
@@ -112,7 +142,11 @@ struct coroutine_handle : public coroutine_handle<void> {
     using coroutine_handle<void>::coroutine_handle;
 
     static coroutine_handle from_promise(_PromiseT& _Prom) {
+#if defined(USE_INLINE_COROUTINE_HANDLE)
+        void* _Addr = __builtin_coro_promise(&_Prom, alignof(_PromiseT), true);
+#else
         auto* _Addr = portable_coro_from_promise(&_Prom, sizeof(_PromiseT));
+#endif
         return coroutine_handle::from_address(_Addr);
     }
     // 17.12.3.1, reset
@@ -128,11 +162,17 @@ struct coroutine_handle : public coroutine_handle<void> {
     }
     // 17.12.3.5, promise access
     _PromiseT& promise() const {
+#if defined(USE_INLINE_COROUTINE_HANDLE)
+        void* _Addr = __builtin_coro_promise(this->address(), //
+                                             alignof(_PromiseT), false);
+        return *reinterpret_cast<_PromiseT*>(_Addr);
+#else
         auto* _Prefix =
             reinterpret_cast<portable_coro_prefix*>(this->address());
         void* _Addr = portable_coro_get_promise(_Prefix, sizeof(_PromiseT));
         _PromiseT* _Prom = reinterpret_cast<_PromiseT*>(_Addr);
         return *_Prom;
+#endif
     }
 };
 
@@ -357,4 +397,4 @@ struct hash<coroutine_handle<_PromiseT>> {
 
 } // namespace std
 
-#endif // _COROUTINE_
\ No newline at end of file
+#endif // _COROUTINE_
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+ * @file coroutine/frame_stat.h
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief Frame size and memory usage of the coroutine types
+ * @copyright CC BY 4.0
+ */
+#pragma once
+#ifndef COROUTINE_FRAME_STAT_H
+#define COROUTINE_FRAME_STAT_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <typeinfo>
+
+/**
+ * @defgroup Introspection
+ * Allocation hooks to measure the coroutine frames
+ */
+
+namespace coro {
+
+/**
+ * @brief Allocation statistics for 1 promise(tag) type
+ * @ingroup Introspection
+ *
+ * All members are updated with relaxed atomic operations.
+ * The values may not be consistent with each other while other threads are
+ * allocating the frames.
+ */
+struct frame_stat final {
+    const char* name = nullptr;
+    const frame_stat* next = nullptr; // linked by `frame_stat_register`
+
+    std::atomic<size_t> frame_size{};     // size of the most recent frame
+    std::atomic<size_t> max_frame_size{}; // largest frame
+    std::atomic<size_t> live_count{};     // allocated - deallocated
+    std::atomic<size_t> live_bytes{};     // bytes of the live frames
+    std::atomic<uint64_t> total_count{};  // number of allocations
+
+  public:
+    void on_allocate(size_t sz) noexcept {
+        frame_size.store(sz, std::memory_order_relaxed);
+        auto prev = max_frame_size.load(std::memory_order_relaxed);
+        while (prev < sz && max_frame_size.compare_exchange_weak(
+                                prev, sz, std::memory_order_relaxed) == false)
+            ;
+        live_count.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_add(sz, std::memory_order_relaxed);
+        total_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    void on_deallocate(size_t sz) noexcept {
+        live_count.fetch_sub(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(sz, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Link the `frame_stat` to the global list. Lock-free.
+ * @note  The object must live until the end of the program
+ * @ingroup Introspection
+ */
+void frame_stat_register(frame_stat& stat) noexcept;
+
+/**
+ * @brief The first item of the registered `frame_stat` list
+ * @return const frame_stat* `nullptr` if there is no registered one
+ * @ingroup Introspection
+ *
+ * ```cpp
+ * for (auto* s = frame_stat_list(); s; s = s->next)
+ *     printf("%s %zu %zu\n", s->name, s->live_count.load(), s->live_bytes.load());
+ * ```
+ */
+auto frame_stat_list() noexcept -> const frame_stat*;
+
+/**
+ * @brief Mixin for promise types. Records the frame allocation to `frame_stat`
+ * @tparam Tag Type to distinguish the statistics. Usually the return type
+ * @ingroup Introspection
+ *
+ * If the compiler elides the allocation, there is nothing to record.
+ *
+ * ```cpp
+ * struct connection_task {
+ *     struct promise_type : public promise_nn,
+ *                           public frame_stat_promise<connection_task> {
+ *         // ...
+ *     };
+ * };
+ * ```
+ */
+template <typename Tag>
+class frame_stat_promise {
+  public:
+    static frame_stat& get_frame_stat() noexcept {
+        static frame_stat* stat = []() noexcept {
+            static frame_stat s{};
+            s.name = typeid(Tag).name();
+            frame_stat_register(s);
+            return &s;
+        }();
+        return *stat;
+    }
+
+    static void* operator new(size_t sz) noexcept(false) {
+        void* ptr = ::operator new(sz);
+        get_frame_stat().on_allocate(sz);
+        return ptr;
+    }
+    static void operator delete(void* ptr, size_t sz) noexcept {
+        get_frame_stat().on_deallocate(sz);
+        ::operator delete(ptr);
+    }
+};
+
+} // namespace coro
+
+#endif // COROUTINE_FRAME_STAT_H
@@ -0,0 +1,264 @@
+/**
+ * @file coroutine/future.hpp
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief `std::future` like return type. The shared state is in the coroutine frame
+ * @copyright CC BY 4.0
+ */
+#pragma once
+#ifndef COROUTINE_FUTURE_HPP
+#define COROUTINE_FUTURE_HPP
+#include <atomic>
+#include <exception>
+#include <utility>
+#include <variant>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <coroutine/return.h>
+
+namespace coro {
+namespace internal {
+
+/**
+ * @brief Block until the value of `word` is different from `expected`
+ * @see futex(2) FUTEX_WAIT_PRIVATE
+ * @see std::atomic<T>::wait
+ */
+inline void wait_on_address(std::atomic<uint32_t>& word,
+                            uint32_t expected) noexcept {
+    while (word.load(std::memory_order_acquire) == expected) {
+#if defined(__linux__)
+        static_assert(sizeof(word) == sizeof(uint32_t));
+        // spurious wake-up and EINTR are handled by the loop
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+                  FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+        word.wait(expected, std::memory_order_acquire);
+#endif
+    }
+}
+
+/**
+ * @brief Wake all threads blocked in `wait_on_address` for the `word`
+ * @see futex(2) FUTEX_WAKE_PRIVATE
+ */
+inline void wake_by_address(std::atomic<uint32_t>& word) noexcept {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+              FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+    word.notify_all();
+#endif
+}
+
+/**
+ * @brief Storage of the `co_return` value or the exception
+ */
+template <typename T>
+class future_storage {
+  protected:
+    std::variant<std::monostate, T, std::exception_ptr> result{};
+
+  public:
+    template <typename U>
+    void return_value(U&& value) noexcept(
+        std::is_nothrow_constructible_v<T, U&&>) {
+        result.template emplace<1>(std::forward<U>(value));
+    }
+    void unhandled_exception() noexcept {
+        result.template emplace<2>(std::current_exception());
+    }
+    T take() noexcept(false) {
+        if (result.index() == 2)
+            std::rethrow_exception(std::get<2>(result));
+        return std::move(std::get<1>(result));
+    }
+};
+
+template <>
+class future_storage<void> {
+  protected:
+    std::variant<std::monostate, std::exception_ptr> result{};
+
+  public:
+    void return_void() noexcept {
+    }
+    void unhandled_exception() noexcept {
+        result.template emplace<1>(std::current_exception());
+    }
+    void take() noexcept(false) {
+        if (result.index() == 1)
+            std::rethrow_exception(std::get<1>(result));
+    }
+};
+
+} // namespace internal
+
+/**
+ * @brief Return type to deliver the result of the coroutine to other thread/coroutine
+ * @ingroup Return
+ * @tparam T type of `co_return`. `void` is allowed
+ *
+ * The coroutine starts immediately. Its result and the synchronization state
+ * are placed in the promise, so there is no allocation except the frame.
+ * Without `co_await`, `get` blocks the current thread with `futex`.
+ *
+ * The object owns the frame. Its destructor waits for the completion,
+ * then destroys the frame.
+ *
+ * ```cpp
+ * auto compute(int a, int b) -> frame_future<int> {
+ *     co_await some_other_thread;
+ *     co_return a + b;
+ * }
+ * auto f = compute(1, 2);
+ * int v1 = f.get();      // blocking
+ * int v2 = co_await f;   // or suspend until the result is ready
+ * ```
+ */
+template <typename T>
+class frame_future final {
+  public:
+    class promise_type;
+
+  private:
+    coroutine_handle<promise_type> coro{};
+
+  public:
+    class promise_type final : public internal::future_storage<T> {
+        friend class frame_future;
+
+        static constexpr uint32_t running = 0, ready = 1;
+        std::atomic<uint32_t> state{running};
+        // nullptr, `coroutine_handle<void>::address()` or the promise itself
+        std::atomic<void*> waiter{};
+
+      private:
+        void* completed() noexcept {
+            return this;
+        }
+
+      public:
+        suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        /**
+         * @brief publish the result and resume the waiter
+         * @note  The frame is suspended here. `frame_future` destroys it
+         */
+        auto final_suspend() noexcept {
+            class awaiter final {
+                promise_type& p;
+
+              public:
+                explicit awaiter(promise_type& _p) noexcept : p{_p} {
+                }
+                bool await_ready() noexcept {
+                    return false;
+                }
+                void await_suspend(coroutine_handle<void>) noexcept {
+                    auto& word = p.state;
+                    void* prev = p.waiter.exchange(p.completed(),
+                                                   std::memory_order_acq_rel);
+                    // from here, the waiters may destroy this frame.
+                    // `wake_by_address` uses the address only.
+                    word.store(ready, std::memory_order_release);
+                    internal::wake_by_address(word);
+                    if (prev)
+                        coroutine_handle<void>::from_address(prev).resume();
+                }
+                void await_resume() noexcept {
+                }
+            };
+            return awaiter{*this};
+        }
+        frame_future get_return_object() noexcept {
+            return frame_future{
+                coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+
+  private:
+    explicit frame_future(coroutine_handle<promise_type> frame) noexcept
+        : coro{frame} {
+    }
+
+  public:
+    frame_future(const frame_future&) = delete;
+    frame_future& operator=(const frame_future&) = delete;
+    frame_future(frame_future&& rhs) noexcept : coro{rhs.coro} {
+        rhs.coro = nullptr;
+    }
+    frame_future& operator=(frame_future&& rhs) noexcept {
+        std::swap(coro, rhs.coro);
+        return *this;
+    }
+    /**
+     * @brief Wait for the completion and destroy the frame
+     */
+    ~frame_future() noexcept {
+        if (coro == nullptr)
+            return;
+        wait();
+        coro.destroy();
+    }
+
+  public:
+    bool is_ready() const noexcept {
+        auto& p = coro.promise();
+        return p.state.load(std::memory_order_acquire) == promise_type::ready;
+    }
+    /**
+     * @brief Block the current thread until the coroutine returns
+     */
+    void wait() const noexcept {
+        auto& p = coro.promise();
+        internal::wait_on_address(p.state, promise_type::running);
+    }
+    /**
+     * @brief Block until the result is ready and move it out
+     * @throw the exception from the coroutine
+     * @note  The result can be taken only once
+     */
+    T get() noexcept(false) {
+        wait();
+        return coro.promise().take();
+    }
+
+    /**
+     * @brief Suspend until the result is ready and move it out
+     */
+    auto operator co_await() noexcept {
+        class awaiter final {
+            promise_type& p;
+
+          public:
+            explicit awaiter(promise_type& _p) noexcept : p{_p} {
+            }
+            bool await_ready() const noexcept {
+                return p.state.load(std::memory_order_acquire) ==
+                       promise_type::ready;
+            }
+            /**
+             * @return false the coroutine returned in the meantime
+             */
+            bool await_suspend(coroutine_handle<void> coro) noexcept {
+                void* expected = nullptr;
+                return p.waiter.compare_exchange_strong(
+                    expected, coro.address(), std::memory_order_acq_rel);
+            }
+            T await_resume() noexcept(false) {
+                return p.take();
+            }
+        };
+        return awaiter{coro.promise()};
+    }
+};
+
+} // namespace coro
+
+#endif // COROUTINE_FUTURE_HPP
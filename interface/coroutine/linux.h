@@ -10,6 +10,14 @@
 #endif
 #include <sys/epoll.h> // for Linux epoll
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <coroutine/return.h>
 #include <gsl/gsl>
 
@@ -72,6 +80,20 @@ class epoll_owner final {
     ptrdiff_t wait(uint32_t wait_ms,
                    gsl::span<epoll_event> list) noexcept(false);
 
+    /**
+     * @brief fetch events with sub-millisecond timeout
+     * @param timeout time to wait. negative value to wait infinitely
+     * @param list
+     * @return ptrdiff_t
+     * @see epoll_pwait2
+     * @throw system_error
+     *
+     * If the system doesn't support `epoll_pwait2`, it uses `epoll_wait`
+     * with the timeout rounded up to milliseconds
+     */
+    ptrdiff_t wait(std::chrono::nanoseconds timeout,
+                   gsl::span<epoll_event> list) noexcept(false);
+
   public:
     /**
      * @brief return temporary awaitable object for given event
@@ -149,7 +171,7 @@ class event final {
  * @return awaitable struct for the binding
  * @ingroup Linux
  */
-auto wait_in(epoll_owner& ep, event& efd) {
+inline auto wait_in(epoll_owner& ep, event& efd) {
     class awaiter : epoll_event {
         epoll_owner& ep;
         event& efd;
@@ -183,6 +205,233 @@ auto wait_in(epoll_owner& ep, event& efd) {
     return awaiter{ep, efd};
 }
 
+/**
+ * @brief Run loop over `epoll_owner` with a ready queue for posted coroutines
+ * @ingroup Linux
+ *
+ * Each thread runs its own loop with `run`. Other threads can move their
+ * coroutines into the loop with `co_await loop.schedule()`.
+ * The posted coroutines are linked through their awaiter objects,
+ * so posting doesn't allocate. When the queue becomes non-empty,
+ * the `eventfd` wakes up the loop's thread.
+ *
+ * For `epoll_event`s from `get_epoll`, `data.ptr` must be a coroutine frame.
+ *
+ * ```cpp
+ * auto serve(event_loop& loop) -> frame_t {
+ *     co_await loop.schedule(); // continue in the loop's thread
+ *     // ...
+ * }
+ * ```
+ */
+class event_loop final {
+  public:
+    class schedule_awaiter;
+
+  private:
+    epoll_owner ep{};
+    int64_t efd;
+    std::atomic<schedule_awaiter*> posted{};
+    std::atomic_bool stopped{};
+    std::array<epoll_event, 64> events{};
+
+  public:
+    /**
+     * @throw system_error
+     */
+    event_loop() noexcept(false);
+    ~event_loop() noexcept;
+    event_loop(const event_loop&) = delete;
+    event_loop(event_loop&&) = delete;
+    event_loop& operator=(const event_loop&) = delete;
+    event_loop& operator=(event_loop&&) = delete;
+
+  private:
+    /**
+     * @brief Lock-free push to the ready queue. Wake the loop if it was empty
+     * @throw system_error
+     */
+    void post(schedule_awaiter* task) noexcept(false);
+    /**
+     * @brief Resume all posted coroutines in FIFO order
+     * @return uint32_t number of the resumed coroutines
+     */
+    uint32_t drain() noexcept(false);
+
+  public:
+    /**
+     * @brief The loop running in the current thread
+     * @return event_loop* `nullptr` if there is no loop in `run`/`run_once`
+     */
+    static event_loop* current() noexcept;
+
+    /**
+     * @brief epoll instance to register the other file descriptors
+     */
+    epoll_owner& get_epoll() noexcept {
+        return ep;
+    }
+
+    /**
+     * @brief Resume the posted coroutines and the coroutines from epoll
+     * @param wait_ms millisecond to wait if there is nothing to resume
+     * @return uint32_t number of the resumed coroutines
+     * @throw system_error
+     */
+    uint32_t run_once(uint32_t wait_ms) noexcept(false);
+
+    /**
+     * @brief Continue `run_once` until `stop` is requested
+     * @throw system_error
+     */
+    void run() noexcept(false);
+
+    /**
+     * @brief Request the return of `run`. Thread-safe
+     */
+    void stop() noexcept(false);
+    bool is_stopped() const noexcept {
+        return stopped.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Awaitable node of the ready queue
+     */
+    class schedule_awaiter final {
+        friend class event_loop;
+
+        event_loop& loop;
+        schedule_awaiter* next = nullptr;
+        coroutine_handle<void> coro{};
+
+      public:
+        explicit schedule_awaiter(event_loop& _loop) noexcept : loop{_loop} {
+        }
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+        /**
+         * @throw system_error
+         */
+        void await_suspend(coroutine_handle<void> handle) noexcept(false) {
+            coro = handle;
+            return loop.post(this);
+        }
+        constexpr void await_resume() const noexcept {
+        }
+    };
+
+    /**
+     * @brief `co_await` to continue the coroutine in the loop's thread
+     */
+    [[nodiscard]] auto schedule() noexcept -> schedule_awaiter {
+        return schedule_awaiter{*this};
+    }
+};
+
+/**
+ * @brief Work-stealing thread pool for coroutines
+ * @ingroup Linux
+ *
+ * Each worker has its own Chase-Lev deque. The coroutines submitted in the
+ * worker's thread are pushed to the deque without lock, and the idle workers
+ * steal from randomly chosen victims. The submission from the other threads
+ * goes to the shared queue. Workers with nothing to do sleep on `futex`.
+ *
+ * @see "Dynamic Circular Work-Stealing Deque" (Chase, Lev, 2005)
+ * @see "Correct and Efficient Work-Stealing for Weak Memory Models" (2013)
+ * @see continue_on_thread_pool
+ */
+class thread_pool final {
+  public:
+    struct worker;
+
+  private:
+    std::vector<std::unique_ptr<worker>> workers{};
+    std::mutex mtx{};
+    std::deque<void*> shared{}; // submission from the non-worker threads
+    std::atomic<uint32_t> epoch{}; // futex word. changes for each submission
+    std::atomic<uint32_t> sleepers{};
+    std::atomic_bool stopped{};
+
+  public:
+    /**
+     * @param count number of the workers. 0 for `hardware_concurrency`
+     * @throw system_error
+     */
+    explicit thread_pool(uint32_t count = 0) noexcept(false);
+    /**
+     * @brief Stop and join all workers
+     * @note  The workers resume the remaining coroutines before they exit
+     */
+    ~thread_pool() noexcept;
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+  private:
+    void run(worker& w) noexcept(false);
+    void* find_work(worker& w) noexcept;
+    void park(uint32_t expected) noexcept;
+    void wake_one() noexcept;
+
+  public:
+    /**
+     * @brief The pool for `continue_on_thread_pool{}`. Created on first use
+     * @throw system_error
+     */
+    static thread_pool& get_default() noexcept(false);
+
+    uint32_t size() const noexcept {
+        return static_cast<uint32_t>(workers.size());
+    }
+
+    /**
+     * @brief Resume the coroutine in one of the workers
+     * @throw system_error
+     */
+    void submit(coroutine_handle<void> coro) noexcept(false);
+};
+
+/**
+ * @brief Move into the `thread_pool` and continue the routine
+ * @ingroup Linux
+ *
+ * ```cpp
+ * auto work() -> frame_t {
+ *     co_await continue_on_thread_pool{}; // the default pool
+ *     // ...
+ * }
+ * ```
+ */
+class continue_on_thread_pool final {
+    thread_pool& pool;
+
+  public:
+    /**
+     * @throw system_error
+     */
+    continue_on_thread_pool() noexcept(false)
+        : pool{thread_pool::get_default()} {
+    }
+    explicit continue_on_thread_pool(thread_pool& _pool) noexcept
+        : pool{_pool} {
+    }
+
+    constexpr bool await_ready() const noexcept {
+        return false;
+    }
+    /**
+     * @throw system_error
+     */
+    void await_suspend(coroutine_handle<void> coro) noexcept(false) {
+        return pool.submit(coro);
+    }
+    constexpr void await_resume() noexcept {
+    }
+};
+
 } // namespace coro
 
 #endif // COROUTINE_SYSTEM_WRAPPER_H
@@ -7,8 +7,14 @@
 #pragma once
 #ifndef COROUTINE_NET_IO_H
 #define COROUTINE_NET_IO_H
+#include <atomic>
+#include <chrono>
 #include <gsl/gsl>
+#include <memory>
+#include <mutex>
+#include <string>
 
+#include <coroutine/future.hpp>
 #include <coroutine/return.h>
 
 /**
@@ -82,7 +88,7 @@ class io_work_t : public io_control_block {
   protected:
     /**
      * @see await_ready
-     * @return true  The given socket can be use for non-blocking operations
+     * @return true  The given socket is blocking. Bypass to the blocking I/O
      * @return false For Windows, the return is always `false`
      */
     bool ready() const noexcept;
@@ -103,12 +109,20 @@ static_assert(sizeof(io_work_t) <= 56);
  * @ingroup Network
  */
 class io_send_to final : public io_work_t {
+    friend class io_deadline;
+
   private:
+    /**
+     * @brief Try the operation before the suspension
+     * @return true The operation is completed, or the socket is blocking
+     */
+    bool ready() noexcept;
     /**
      * @brief makes an I/O request with given context(`coroutine_handle<void>`)
+     * @return false The operation is completed without suspension
      * @throw std::system_error
      */
-    void suspend(coroutine_handle<void> t) noexcept(false);
+    bool suspend(coroutine_handle<void> t) noexcept(false);
     /**
      * @brief Fetch I/O result/error
      * @return int64_t return of `sendto`
@@ -119,13 +133,13 @@ class io_send_to final : public io_work_t {
     int64_t resume() noexcept;
 
   public:
-    bool await_ready() const noexcept {
+    bool await_ready() noexcept {
         return this->ready();
     }
     /**
      * @throw std::system_error
      */
-    void await_suspend(coroutine_handle<void> t) noexcept(false) {
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
         return this->suspend(t);
     }
     int64_t await_resume() noexcept {
@@ -141,12 +155,20 @@ static_assert(sizeof(io_send_to) == sizeof(io_work_t));
  * @ingroup Network
  */
 class io_recv_from final : public io_work_t {
+    friend class io_deadline;
+
   private:
+    /**
+     * @brief Try the operation before the suspension
+     * @return true The operation is completed, or the socket is blocking
+     */
+    bool ready() noexcept;
     /**
      * @brief makes an I/O request with given context(`coroutine_handle<void>`)
+     * @return false The operation is completed without suspension
      * @throw std::system_error
      */
-    void suspend(coroutine_handle<void> t) noexcept(false);
+    bool suspend(coroutine_handle<void> t) noexcept(false);
     /**
      * @brief Fetch I/O result/error
      * @return int64_t return of `recvfrom`
@@ -157,13 +179,13 @@ class io_recv_from final : public io_work_t {
     int64_t resume() noexcept;
 
   public:
-    bool await_ready() const noexcept {
+    bool await_ready() noexcept {
         return this->ready();
     }
     /**
      * @throw std::system_error
      */
-    void await_suspend(coroutine_handle<void> t) noexcept(false) {
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
         return this->suspend(t);
     }
     int64_t await_resume() noexcept {
@@ -179,12 +201,20 @@ static_assert(sizeof(io_recv_from) == sizeof(io_work_t));
  * @ingroup Network
  */
 class io_send final : public io_work_t {
+    friend class io_deadline;
+
   private:
+    /**
+     * @brief Try the operation before the suspension
+     * @return true The operation is completed, or the socket is blocking
+     */
+    bool ready() noexcept;
     /**
      * @brief makes an I/O request with given context(`coroutine_handle<void>`)
+     * @return false The operation is completed without suspension
      * @throw std::system_error
      */
-    void suspend(coroutine_handle<void> t) noexcept(false);
+    bool suspend(coroutine_handle<void> t) noexcept(false);
     /**
      * @brief Fetch I/O result/error
      * @return int64_t return of `send`
@@ -195,10 +225,10 @@ class io_send final : public io_work_t {
     int64_t resume() noexcept;
 
   public:
-    bool await_ready() const noexcept {
+    bool await_ready() noexcept {
         return this->ready();
     }
-    void await_suspend(coroutine_handle<void> t) noexcept(false) {
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
         return this->suspend(t);
     }
     int64_t await_resume() noexcept {
@@ -214,12 +244,20 @@ static_assert(sizeof(io_send) == sizeof(io_work_t));
  * @ingroup Network
  */
 class io_recv final : public io_work_t {
+    friend class io_deadline;
+
   private:
+    /**
+     * @brief Try the operation before the suspension
+     * @return true The operation is completed, or the socket is blocking
+     */
+    bool ready() noexcept;
     /**
      * @brief makes an I/O request with given context(`coroutine_handle<void>`)
+     * @return false The operation is completed without suspension
      * @throw std::system_error
      */
-    void suspend(coroutine_handle<void> t) noexcept(false);
+    bool suspend(coroutine_handle<void> t) noexcept(false);
 
     /**
      * @brief Fetch I/O result/error
@@ -231,10 +269,10 @@ class io_recv final : public io_work_t {
     int64_t resume() noexcept;
 
   public:
-    bool await_ready() const noexcept {
+    bool await_ready() noexcept {
         return this->ready();
     }
-    void await_suspend(coroutine_handle<void> t) noexcept(false) {
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
         return this->suspend(t);
     }
     int64_t await_resume() noexcept {
@@ -321,11 +359,1034 @@ auto send_stream(uint64_t sd, io_buffer_t buf, uint32_t flag,
 auto recv_stream(uint64_t sd, io_buffer_t buf, uint32_t flag,
                  io_work_t& work) noexcept(false) -> io_recv&;
 
+#if defined(__linux__)
+/**
+ * @brief I/O mechanism for the awaitables in this header
+ * @ingroup Network
+ */
+enum class io_backend : uint32_t {
+    /** @brief readiness with epoll. The operation is done in `await_resume` */
+    epoll = 1,
+    /** @brief completion with io_uring. `await_resume` receives the result */
+    io_uring = 2,
+};
+
+/**
+ * @brief Change the I/O mechanism. The default is `io_backend::epoll`.
+ *        With CMake option `USE_IO_URING`, `io_backend::io_uring` if possible
+ * @return false The system doesn't support it. The current one is kept
+ * @note   There must be no pending I/O works when it is changed.
+ *         Change it before the I/O threads start
+ * @see io_uring_setup
+ *
+ * It applies to all threads, but the calls are serialized.
+ * With `io_backend::io_uring`, each thread has its own ring like the reactor
+ * of `io_backend::epoll`. The work is completed in `poll_net_tasks` of the
+ * thread which started it, and the thread must not exit before that.
+ *
+ * @ingroup Network
+ */
+bool select_io_backend(io_backend backend) noexcept;
+
+/**
+ * @ingroup Network
+ */
+io_backend get_io_backend() noexcept;
+
+/**
+ * @brief Remove the socket from the internal epoll instance
+ * @note  With `io_backend::epoll`, the socket is registered at its first
+ *        suspension and stays registered. Use this before `close`.
+ *        Without it, the next socket with the same descriptor is detected
+ *        with `fstat` at its suspension, and registered again
+ *
+ * @ingroup Network
+ */
+void unregister_socket(uint64_t sd) noexcept;
+
+/**
+ * @brief Bind the socket to the reactor of the current thread
+ * @throw std::system_error `EBUSY` if a coroutine is waiting for the socket
+ *
+ * With `io_backend::epoll`, each thread has its own reactor (epoll instance).
+ * A socket is bound to the reactor of the thread that awaited it first,
+ * and its coroutines are resumed by `poll_net_tasks` of that thread.
+ * The sockets must be unregistered or migrated before the thread exits.
+ *
+ * @ingroup Network
+ */
+void migrate_socket(uint64_t sd) noexcept(false);
+
+/**
+ * @brief Create a non-blocking TCP listener with `SO_REUSEPORT`
+ * @throw std::system_error
+ *
+ * Each thread can create its own listener for the same address.
+ * Then the system distributes the incoming connections to them,
+ * and each thread can accept and serve its own ones.
+ *
+ * @ingroup Network
+ */
+int64_t listen_reuseport(const sockaddr_in& local, //
+                         int backlog) noexcept(false);
+int64_t listen_reuseport(const sockaddr_in6& local, //
+                         int backlog) noexcept(false);
+
+/**
+ * @brief Awaitable type to perform `sendmsg` I/O request
+ * @see sendmsg
+ * @ingroup Network
+ *
+ * The `msghdr` describes the buffers(`iovec`), the remote address and
+ * the ancillary data. A multi-part message is sent with 1 suspension.
+ * It must live until the end of the `co_await`.
+ */
+class io_send_msg final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `sendmsg`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_send_msg) == sizeof(io_work_t));
+
+/**
+ * @brief Awaitable type to perform `recvmsg` I/O request
+ * @see recvmsg
+ * @ingroup Network
+ *
+ * The buffers(`iovec`) are filled in order. After the `co_await`,
+ * `msg_namelen`, `msg_controllen` and `msg_flags` are updated by the system.
+ * It must live until the end of the `co_await`.
+ */
+class io_recv_msg final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `recvmsg`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_recv_msg) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_send_msg` awaitable with the given parameters
+ * @param sd
+ * @param msg  buffers, (optional) remote address and ancillary data
+ * @param flag `MSG_*` for `sendmsg`
+ * @param work
+ * @return io_send_msg&
+ *
+ * @ingroup Network
+ */
+auto send_msg(uint64_t sd, const msghdr& msg, uint32_t flag,
+              io_work_t& work) noexcept(false) -> io_send_msg&;
+
+/**
+ * @brief Constructs `io_recv_msg` awaitable with the given parameters
+ * @param sd
+ * @param msg  buffers, (optional) remote address and ancillary data
+ * @param flag `MSG_*` for `recvmsg`
+ * @param work
+ * @return io_recv_msg&
+ *
+ * @ingroup Network
+ */
+auto recv_msg(uint64_t sd, msghdr& msg, uint32_t flag,
+              io_work_t& work) noexcept(false) -> io_recv_msg&;
+
+/**
+ * @brief Awaitable type to perform `sendmmsg` I/O request
+ * @see sendmmsg
+ * @ingroup Network
+ *
+ * Each `mmsghdr` is 1 datagram with its own remote address.
+ * `await_resume` returns the number of the datagrams sent,
+ * and their `msg_len` are updated. It can be less than the given ones.
+ */
+class io_send_batch final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `sendmmsg`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_send_batch) == sizeof(io_work_t));
+
+/**
+ * @brief Awaitable type to perform `recvmmsg` I/O request
+ * @see recvmmsg
+ * @ingroup Network
+ *
+ * The datagrams in the socket are received at once, up to the given slots.
+ * `await_resume` returns the number of the received ones. For each of them,
+ * `msg_len` is its length and `msg_hdr.msg_name` is the remote address.
+ */
+class io_recv_batch final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `recvmmsg`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_recv_batch) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_send_batch` awaitable with the given parameters
+ * @param sd
+ * @param msgs datagrams to send. They must live until the end of `co_await`
+ * @param flag `MSG_*` for `sendmmsg`
+ * @param work
+ * @return io_send_batch&
+ *
+ * @ingroup Network
+ */
+auto send_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_send_batch&;
+
+/**
+ * @brief Constructs `io_recv_batch` awaitable with the given parameters
+ * @param sd
+ * @param msgs slots for the datagrams. Each has its own buffer and address
+ * @param flag `MSG_*` for `recvmmsg`
+ * @param work
+ * @return io_recv_batch&
+ *
+ * @ingroup Network
+ */
+auto recv_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_recv_batch&;
+
+/**
+ * @brief Awaitable type to perform `send` with `MSG_ZEROCOPY`
+ * @see send
+ * @see io_uring_enter
+ * @ingroup Network
+ *
+ * The coroutine is resumed after the system's notification. Then the buffer
+ * can be reused. The system doesn't copy the buffer if possible.
+ * If the buffer is small(< 16 KB), or the socket doesn't support
+ * `SO_ZEROCOPY`, it falls back to `send` that copies the buffer.
+ *
+ * With `io_backend::io_uring`, it is `IORING_OP_SEND_ZC`(Linux 6.0).
+ * With `io_backend::epoll`, the notifications in the error queue of
+ * the socket are received in `poll_net_tasks`. Only 1 coroutine can wait
+ * for them at once.
+ */
+class io_send_zerocopy final : public io_work_t {
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `send`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_send_zerocopy) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_send_zerocopy` awaitable with the given parameters
+ * @param sd
+ * @param buf  it must not be modified until the end of `co_await`
+ * @param flag `MSG_*` for `send`
+ * @param work
+ * @return io_send_zerocopy&
+ *
+ * @ingroup Network
+ */
+auto send_zerocopy(uint64_t sd, io_buffer_t buf, uint32_t flag,
+                   io_work_t& work) noexcept(false) -> io_send_zerocopy&;
+
+/**
+ * @brief Awaitable type to perform `accept4` I/O request
+ * @see accept4
+ * @ingroup Network
+ *
+ * The accepted sockets are non-blocking and close-on-exec.
+ * For 1 socket, `await_resume` returns it. For the span, it drains the
+ * backlog up to its size and returns the number of the accepted sockets.
+ */
+class io_accept final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_accept) == sizeof(io_work_t));
+
+/**
+ * @brief Awaitable type to perform `connect` I/O request
+ * @see connect
+ * @ingroup Network
+ *
+ * For the non-blocking socket, it is completed when the socket becomes
+ * writable. Then `SO_ERROR` is the result. `await_resume` returns 0,
+ * or -1 with the error like `ECONNREFUSED`.
+ */
+class io_connect final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_connect) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_accept` awaitable for 1 socket
+ * @param ln listening socket
+ * @param work
+ * @return io_accept& `await_resume` returns the accepted socket
+ *
+ * @ingroup Network
+ */
+auto accept(uint64_t ln, io_work_t& work) noexcept(false) -> io_accept&;
+
+/**
+ * @brief Constructs `io_accept` awaitable for the pending connections
+ * @param ln listening socket
+ * @param sockets the accepted ones are stored in order
+ * @param work
+ * @return io_accept& `await_resume` returns the number of them
+ *
+ * @ingroup Network
+ */
+auto accept(uint64_t ln, gsl::span<int64_t> sockets,
+            io_work_t& work) noexcept(false) -> io_accept&;
+
+/**
+ * @brief Constructs `io_connect` awaitable with the given parameters
+ * @param sd
+ * @param remote it must live until the end of the `co_await`
+ * @param work
+ * @return io_connect&
+ *
+ * @ingroup Network
+ */
+auto connect(uint64_t sd, const sockaddr_in& remote,
+             io_work_t& work) noexcept(false) -> io_connect&;
+auto connect(uint64_t sd, const sockaddr_in6& remote,
+             io_work_t& work) noexcept(false) -> io_connect&;
+
+/**
+ * @brief Awaitable type to perform `sendfile` I/O request
+ * @see sendfile
+ * @ingroup Network
+ *
+ * The file is sent to the socket without the copy to the user space.
+ * `await_resume` returns the bytes sent. It can be less than the requested.
+ */
+class io_send_file final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of `sendfile`
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_send_file) == sizeof(io_work_t));
+
+/**
+ * @brief Non-blocking pipe between the file and the socket for `splice_file`
+ * @ingroup Network
+ *
+ * The data moved from the file stays in the pipe until it is sent.
+ * Keep 1 pipe for each connection, and reuse it for the following ones.
+ */
+class io_pipe final {
+  public:
+    int64_t reader = -1;
+    int64_t writer = -1;
+    size_t pending = 0; // bytes in the pipe
+
+  public:
+    /**
+     * @throw std::system_error
+     */
+    io_pipe() noexcept(false);
+    ~io_pipe() noexcept;
+    io_pipe(const io_pipe&) = delete;
+    io_pipe(io_pipe&&) = delete;
+    io_pipe& operator=(const io_pipe&) = delete;
+    io_pipe& operator=(io_pipe&&) = delete;
+};
+
+/**
+ * @brief Awaitable type to perform `splice` from the file to the socket
+ * @see splice
+ * @ingroup Network
+ *
+ * The pages of the file are moved to the pipe, then to the socket.
+ * `await_resume` returns the bytes sent to the socket. If the pipe has
+ * the remaining of the previous one, they are sent first.
+ */
+class io_splice_file final : public io_work_t {
+    friend class io_deadline;
+
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    /**
+     * @return int64_t return of the `splice` to the socket
+     */
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_splice_file) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_send_file` awaitable with the given parameters
+ * @param sd
+ * @param fd     file to read
+ * @param offset position in the file. It is advanced with the bytes sent
+ * @param count  bytes to send
+ * @param work
+ * @return io_send_file&
+ *
+ * @ingroup Network
+ */
+auto send_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+               io_work_t& work) noexcept(false) -> io_send_file&;
+
+/**
+ * @brief Constructs `io_splice_file` awaitable with the given parameters
+ * @param sd
+ * @param fd     file to read
+ * @param offset position in the file. It is advanced with the bytes
+ *               moved to the pipe
+ * @param count  bytes to move from the file at once
+ * @param pipe   it must live until the end of the `co_await`
+ * @param work
+ * @return io_splice_file&
+ *
+ * @ingroup Network
+ */
+auto splice_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+                 io_pipe& pipe, io_work_t& work) noexcept(false)
+    -> io_splice_file&;
+
+/**
+ * @brief `msghdr` and its control buffer for UDP GSO/GRO
+ * @note  It must live until the end of the `co_await`
+ * @see send_segments
+ * @see recv_segments
+ * @ingroup Network
+ */
+struct io_segment_msg final {
+    msghdr hdr;
+    iovec iov;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+};
+
+/**
+ * @brief Enable/disable `UDP_GRO` of the socket
+ * @throw std::system_error `ENOPROTOOPT` if the system doesn't support it
+ *
+ * With GRO, the datagrams of the same flow and size can be received as
+ * 1 coalesced buffer. See `recv_segments` for their segment size.
+ *
+ * @ingroup Network
+ */
+void set_udp_gro(uint64_t sd, bool enable) noexcept(false);
+
+/**
+ * @brief Send the buffer as the datagrams of `segment` bytes with `UDP_SEGMENT`
+ * @param segment size of each datagram. The last one can be shorter
+ * @return io_send_msg& `await_resume` returns the bytes of the whole buffer
+ *
+ * The system segments the buffer, so the stack is traversed once.
+ * The buffer can be up to 64 KB, and the number of the segments is limited.
+ * If the system doesn't support it, the error is `EIO` or `EINVAL`.
+ *
+ * @ingroup Network
+ */
+auto send_segments(uint64_t sd, const sockaddr_in& remote, io_buffer_t buf,
+                   uint16_t segment, io_segment_msg& msg,
+                   io_work_t& work) noexcept(false) -> io_send_msg&;
+auto send_segments(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buf,
+                   uint16_t segment, io_segment_msg& msg,
+                   io_work_t& work) noexcept(false) -> io_send_msg&;
+
+/**
+ * @brief Receive the coalesced datagrams of the `set_udp_gro` socket
+ * @return io_recv_msg& `await_resume` returns the bytes of the whole buffer
+ * @see get_segment_size
+ *
+ * @ingroup Network
+ */
+auto recv_segments(uint64_t sd, sockaddr_in& remote, io_buffer_t buf,
+                   io_segment_msg& msg, io_work_t& work) noexcept(false)
+    -> io_recv_msg&;
+auto recv_segments(uint64_t sd, sockaddr_in6& remote, io_buffer_t buf,
+                   io_segment_msg& msg, io_work_t& work) noexcept(false)
+    -> io_recv_msg&;
+
+/**
+ * @brief Size of each datagram in the buffer of `recv_segments`
+ * @return 0 if it is not coalesced. The buffer is 1 datagram
+ *
+ * @ingroup Network
+ */
+uint16_t get_segment_size(const io_segment_msg& msg) noexcept;
+
+/**
+ * @brief Size-classed buffers shared by the connections
+ * @see recv_lease
+ * @ingroup Network
+ *
+ * The classes are the powers of 2 from `min_size` to `max_size`.
+ * Released buffers are kept in the free list of their class, up to
+ * `retain` bytes for each class. The rest are returned to the system.
+ * It is thread-safe.
+ */
+class io_buffer_pool final {
+  public:
+    static constexpr size_t min_size = 512;
+    static constexpr size_t max_size = 64 * 1024;
+    static constexpr size_t class_count = 8;
+
+  private:
+    std::mutex mtx{};
+    void* heads[class_count]{}; // free lists
+    size_t cached[class_count]{};
+    size_t retain;
+    size_t count = 0; // leased buffers
+
+  public:
+    explicit io_buffer_pool(size_t retain = 1024 * 1024) noexcept;
+    ~io_buffer_pool() noexcept;
+    io_buffer_pool(const io_buffer_pool&) = delete;
+    io_buffer_pool(io_buffer_pool&&) = delete;
+    io_buffer_pool& operator=(const io_buffer_pool&) = delete;
+    io_buffer_pool& operator=(io_buffer_pool&&) = delete;
+
+  public:
+    /**
+     * @brief Lease a buffer of the smallest class for the size
+     * @return io_buffer_t its size is the size of the class
+     * @throw std::system_error `EINVAL` if the size is over `max_size`
+     * @throw std::bad_alloc
+     */
+    auto acquire(size_t size) noexcept(false) -> io_buffer_t;
+    /**
+     * @brief Return the buffer from `acquire`
+     * @param buffer it can be shorter than the leased one
+     */
+    void release(io_buffer_t buffer) noexcept;
+    /**
+     * @return size_t the number of the buffers not released yet
+     */
+    size_t leased() noexcept;
+};
+
+/**
+ * @brief The buffer of `recv_lease`. Nothing is leased while it waits
+ * @ingroup Network
+ *
+ * After the `co_await`, `buffer` is the received bytes. It is returned to
+ * the pool with `release`, the next `recv_lease`, or the destructor.
+ */
+class io_lease final {
+  public:
+    io_buffer_pool& pool;
+    io_buffer_t buffer{};
+
+  public:
+    explicit io_lease(io_buffer_pool& pool) noexcept : pool{pool} {
+    }
+    ~io_lease() noexcept {
+        release();
+    }
+    io_lease(const io_lease&) = delete;
+    io_lease(io_lease&&) = delete;
+    io_lease& operator=(const io_lease&) = delete;
+    io_lease& operator=(io_lease&&) = delete;
+
+    void release() noexcept {
+        if (buffer.empty())
+            return;
+        pool.release(buffer);
+        buffer = {};
+    }
+};
+
+/**
+ * @brief Awaitable type to perform `recv` with the buffer from `io_lease`
+ * @see recv
+ * @ingroup Network
+ *
+ * The buffer is leased when the socket is readable, and returned at once
+ * if there is nothing to receive. So the idle connections don't hold it.
+ * `await_resume` returns the bytes in `io_lease::buffer`.
+ */
+class io_recv_lease final : public io_work_t {
+  private:
+    bool ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool suspend(coroutine_handle<void> t) noexcept(false);
+    int64_t resume() noexcept;
+
+  public:
+    bool await_ready() noexcept {
+        return this->ready();
+    }
+    bool await_suspend(coroutine_handle<void> t) noexcept(false) {
+        return this->suspend(t);
+    }
+    int64_t await_resume() noexcept {
+        return this->resume();
+    }
+};
+static_assert(sizeof(io_recv_lease) == sizeof(io_work_t));
+
+/**
+ * @brief Constructs `io_recv_lease` awaitable with the given parameters
+ * @param sd
+ * @param lease the previous buffer is released
+ * @param size the buffer is the smallest class for this size
+ * @param flag
+ * @param work
+ * @return io_recv_lease&
+ *
+ * @ingroup Network
+ */
+auto recv_lease(uint64_t sd, io_lease& lease, size_t size, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_recv_lease&;
+
+/**
+ * @brief Entry of the timer wheel of the current thread
+ * @note  The timer must be cancelled in the thread which started it
+ * @see poll_net_tasks
+ *
+ * The wheel is hierarchical. 4 levels of 256 slots with 1 millisecond tick.
+ * Its insert and cancel are O(1), and the destructor cancels the timer.
+ *
+ * @ingroup Network
+ */
+class io_timer {
+  public:
+    io_timer* next = nullptr;
+    io_timer* prev = nullptr;
+    uint64_t expiry = 0; // millisecond tick of `steady_clock`
+    coroutine_handle<void> task{};
+    // if not null, invoked instead of resuming the `task`
+    void (*on_expire)(io_timer&) = nullptr;
+
+  public:
+    io_timer() noexcept = default;
+    ~io_timer() noexcept {
+        cancel();
+    }
+    io_timer(const io_timer&) = delete;
+    io_timer(io_timer&&) = delete;
+    io_timer& operator=(const io_timer&) = delete;
+    io_timer& operator=(io_timer&&) = delete;
+
+  public:
+    /**
+     * @brief Remove the timer from the wheel. The coroutine won't be resumed
+     */
+    void cancel() noexcept;
+};
+
+/**
+ * @brief Awaitable type to suspend until the time point
+ * @see sleep_for
+ * @see sleep_until
+ * @ingroup Network
+ *
+ * The coroutine is resumed by `poll_net_tasks` of the thread that awaited it
+ */
+class io_sleep final : public io_timer {
+    std::chrono::steady_clock::time_point until;
+
+  public:
+    explicit io_sleep(std::chrono::steady_clock::time_point tp) noexcept;
+
+    bool await_ready() const noexcept;
+    void await_suspend(coroutine_handle<void> coro) noexcept;
+    void await_resume() noexcept {
+    }
+};
+
+/**
+ * @ingroup Network
+ */
+io_sleep sleep_until(std::chrono::steady_clock::time_point tp) noexcept;
+/**
+ * @ingroup Network
+ */
+io_sleep sleep_for(std::chrono::steady_clock::duration duration) noexcept;
+
+class io_deadline;
+
+/**
+ * @brief Cancellation source for the I/O works with `io_deadline`
+ * @note  Not thread-safe. Use it in the thread of `poll_net_tasks`
+ * @ingroup Network
+ */
+class io_cancel_token final {
+    friend class io_deadline;
+
+    io_deadline* head = nullptr; // waiting works
+    bool requested = false;
+
+  public:
+    io_cancel_token() noexcept = default;
+    ~io_cancel_token() noexcept;
+    io_cancel_token(const io_cancel_token&) = delete;
+    io_cancel_token(io_cancel_token&&) = delete;
+    io_cancel_token& operator=(const io_cancel_token&) = delete;
+    io_cancel_token& operator=(io_cancel_token&&) = delete;
+
+  public:
+    bool is_cancelled() const noexcept {
+        return requested;
+    }
+    /**
+     * @brief Resume the waiting coroutines with `ECANCELED`.
+     *        The following works with this token fail without the operation
+     * @throw std::system_error
+     *
+     * The resumed coroutines can destroy the token.
+     */
+    void cancel() noexcept(false);
+};
+
+/**
+ * @brief Awaitable type to perform the I/O request with deadline
+ * @ingroup Network
+ *
+ * If the work is still pending at the deadline, it is aborted and
+ * `await_resume` returns -1 with `ETIMEDOUT` in `io_work_t::error`.
+ * With `io_cancel_token::cancel`, `ECANCELED` in the same way.
+ * The aborted coroutine is resumed in the thread of `poll_net_tasks`.
+ *
+ * The deadline is not applied to the blocking sockets.
+ */
+class io_deadline final : public io_timer {
+    friend class io_cancel_token;
+
+  public:
+    enum class operation : uint32_t {
+        send_to = 1,
+        recv_from,
+        send,
+        recv,
+        send_msg,
+        recv_msg,
+        send_batch,
+        recv_batch,
+        send_file,
+        splice_file,
+        accept,
+        connect,
+    };
+
+  private:
+    io_work_t& work;
+    const operation op;
+    uint32_t reason = 0; // error code for the abort
+    std::chrono::steady_clock::time_point until;
+    io_cancel_token* token;
+    io_deadline* token_next = nullptr;
+    io_deadline* token_prev = nullptr;
+
+  private:
+    void link(io_cancel_token& source) noexcept;
+    void unlink() noexcept;
+    /**
+     * @brief Release the pending work and resume it with the error code
+     * @throw std::system_error
+     */
+    void abort(uint32_t errc) noexcept(false);
+    static void on_deadline(io_timer& timer) noexcept(false);
+
+  public:
+    io_deadline(io_work_t& work, operation op,
+                std::chrono::steady_clock::time_point until,
+                io_cancel_token* token) noexcept;
+    ~io_deadline() noexcept;
+
+    bool await_ready() noexcept;
+    /**
+     * @throw std::system_error
+     */
+    bool await_suspend(coroutine_handle<void> coro) noexcept(false);
+    int64_t await_resume() noexcept;
+};
+
+/**
+ * @brief `send_to` with deadline and cancellation
+ * @param deadline `time_point::max()` for no deadline
+ * @param token    can be `nullptr`
+ * @ingroup Network
+ */
+auto send_to(uint64_t sd, const sockaddr_in& remote, io_buffer_t buf,
+             io_work_t& work, std::chrono::steady_clock::time_point deadline,
+             io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+auto send_to(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buf,
+             io_work_t& work, std::chrono::steady_clock::time_point deadline,
+             io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+/**
+ * @brief `recv_from` with deadline and cancellation
+ * @ingroup Network
+ */
+auto recv_from(uint64_t sd, sockaddr_in& remote, io_buffer_t buf,
+               io_work_t& work, std::chrono::steady_clock::time_point deadline,
+               io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+auto recv_from(uint64_t sd, sockaddr_in6& remote, io_buffer_t buf,
+               io_work_t& work, std::chrono::steady_clock::time_point deadline,
+               io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `send_stream` with deadline and cancellation
+ * @ingroup Network
+ */
+auto send_stream(uint64_t sd, io_buffer_t buf, uint32_t flag,
+                 io_work_t& work,
+                 std::chrono::steady_clock::time_point deadline,
+                 io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `recv_stream` with deadline and cancellation
+ * @ingroup Network
+ */
+auto recv_stream(uint64_t sd, io_buffer_t buf, uint32_t flag,
+                 io_work_t& work,
+                 std::chrono::steady_clock::time_point deadline,
+                 io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `send_msg` with deadline and cancellation
+ * @ingroup Network
+ */
+auto send_msg(uint64_t sd, const msghdr& msg, uint32_t flag, io_work_t& work,
+              std::chrono::steady_clock::time_point deadline,
+              io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+/**
+ * @brief `recv_msg` with deadline and cancellation
+ * @ingroup Network
+ */
+auto recv_msg(uint64_t sd, msghdr& msg, uint32_t flag, io_work_t& work,
+              std::chrono::steady_clock::time_point deadline,
+              io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+/**
+ * @brief `send_batch` with deadline and cancellation
+ * @ingroup Network
+ */
+auto send_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work,
+                std::chrono::steady_clock::time_point deadline,
+                io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `recv_batch` with deadline and cancellation
+ * @ingroup Network
+ */
+auto recv_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work,
+                std::chrono::steady_clock::time_point deadline,
+                io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `send_file` with deadline and cancellation
+ * @ingroup Network
+ */
+auto send_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+               io_work_t& work,
+               std::chrono::steady_clock::time_point deadline,
+               io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `splice_file` with deadline and cancellation
+ * @ingroup Network
+ */
+auto splice_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+                 io_pipe& pipe, io_work_t& work,
+                 std::chrono::steady_clock::time_point deadline,
+                 io_cancel_token* token = nullptr) noexcept(false)
+    -> io_deadline;
+/**
+ * @brief `accept` with deadline and cancellation
+ * @ingroup Network
+ */
+auto accept(uint64_t ln, io_work_t& work,
+            std::chrono::steady_clock::time_point deadline,
+            io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+auto accept(uint64_t ln, gsl::span<int64_t> sockets, io_work_t& work,
+            std::chrono::steady_clock::time_point deadline,
+            io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+/**
+ * @brief `connect` with deadline and cancellation
+ * @ingroup Network
+ */
+auto connect(uint64_t sd, const sockaddr_in& remote, io_work_t& work,
+             std::chrono::steady_clock::time_point deadline,
+             io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+auto connect(uint64_t sd, const sockaddr_in6& remote, io_work_t& work,
+             std::chrono::steady_clock::time_point deadline,
+             io_cancel_token* token = nullptr) noexcept(false) -> io_deadline;
+#endif
+
 /**
  * @brief Poll internal I/O works and invoke user callback
  * @param nano timeout in nanoseconds 
  * @throw std::system_error
  * 
+ * For Linux, it waits once with the timeout and continues without waiting
+ * until nothing is ready. The wait is shortened for the timers of the thread.
+ * For `io_backend::io_uring`, the I/O requests are submitted here together
+ * 
  * @ingroup Network
  */
 void poll_net_tasks(uint64_t nano) noexcept(false);
@@ -395,6 +1456,167 @@ uint32_t get_name(const sockaddr_in6& addr, //
                   gsl::zstring<NI_MAXHOST> name, gsl::zstring<NI_MAXSERV> serv,
                   int32_t flags = NI_NUMERICHOST | NI_NUMERICSERV) noexcept;
 
+#if defined(__linux__)
+/**
+ * @brief TTL-aware cache for the async `get_address`
+ * @see dns_config
+ * @ingroup Network
+ *
+ * The entries are keyed by host, service and hint. The answers live for the
+ * smallest TTL of their records(up to `max_ttl`), and `EAI_NONAME` lives for
+ * `negative_ttl`. The other errors are not cached.
+ *
+ * The lookup doesn't take a lock. The entries are in an immutable table, and
+ * the insertion replaces it with a new copy. So it fits the read-mostly use.
+ * The replaced tables are deleted when their readers are gone.
+ * When the same key is being queried, the others wait for its result instead
+ * of sending the same query. They are resumed by the thread of the first one.
+ */
+class dns_cache final {
+    friend struct dns_client;
+    struct entry;
+    struct table;
+    struct pending;
+    struct writer;
+    class join_awaitable;
+
+    std::atomic<const table*> current;
+    std::atomic<uint32_t> epoch{}; // the slot of `readers` for new readers
+    std::atomic<uint32_t> readers[2]{};
+    std::unique_ptr<writer> state;
+    const std::chrono::seconds negative_ttl;
+    const std::chrono::seconds max_ttl;
+    const size_t capacity;
+
+  private:
+    auto acquire(uint32_t& slot) noexcept -> const table*;
+    void release(uint32_t slot) noexcept;
+    void reclaim() noexcept;
+    bool find(const std::string& key, entry& output) noexcept(false);
+    void insert(const std::string& key, const entry& item) noexcept(false);
+    void finish(const std::string& key, pending& leader) noexcept(false);
+
+  public:
+    /**
+     * @param capacity the entry which expires first is evicted over this
+     * @throw std::bad_alloc
+     */
+    explicit dns_cache(
+        std::chrono::seconds negative_ttl = std::chrono::seconds{5},
+        std::chrono::seconds max_ttl = std::chrono::seconds{3600},
+        size_t capacity = 1024) noexcept(false);
+    ~dns_cache() noexcept;
+    dns_cache(const dns_cache&) = delete;
+    dns_cache(dns_cache&&) = delete;
+    dns_cache& operator=(const dns_cache&) = delete;
+    dns_cache& operator=(dns_cache&&) = delete;
+
+    /**
+     * @return size_t the number of the entries not expired
+     */
+    size_t size() noexcept;
+};
+
+/**
+ * @brief Name server for the async `get_address`/`get_name`
+ * @see load_dns_config
+ * @ingroup Network
+ */
+struct dns_config final {
+    sockaddr_in server{}; // UDP port 53 of the name server
+    std::chrono::milliseconds timeout{2000}; // for each attempt
+    uint32_t attempts = 2;
+    dns_cache* cache = nullptr; // optional. it must outlive the queries
+};
+
+/**
+ * @brief Use the first IPv4 `nameserver` of the `resolv.conf`
+ * @return uint32_t 0, `EAI_SYSTEM` if the file can't be read,
+ *                  or `EAI_FAIL` if there is no name server
+ * @ingroup Network
+ */
+uint32_t load_dns_config(dns_config& config,
+                         gsl::czstring<> path = "/etc/resolv.conf") noexcept;
+
+/**
+ * @brief `get_address` with the UDP query for the A record
+ * @param host numeric address is converted without the query
+ * @param serv port number. `nullptr` for 0
+ * @return frame_future<uint32_t> 0 or the `EAI_*` error code
+ * @note   `hint`, `host`, `serv` and `output` must live until the result
+ *
+ * The query is sent and received with `send_to`/`recv_from` in the thread
+ * of `poll_net_tasks`, so the loop is not blocked. If there is no answer in
+ * `dns_config::timeout`, it is sent again. After all `attempts`, the error
+ * is `EAI_AGAIN`. The output is filled from the front, and the rest is not
+ * changed. Truncated answers(TCP fallback) are not supported.
+ *
+ * @ingroup Network
+ */
+auto get_address(dns_config config, const addrinfo& hint, //
+                 gsl::czstring<> host, gsl::czstring<> serv,
+                 gsl::span<sockaddr_in> output) noexcept(false)
+    -> frame_future<uint32_t>;
+
+/**
+ * @brief `get_address` with the UDP query for the AAAA record
+ * @see get_address
+ * @ingroup Network
+ */
+auto get_address(dns_config config, const addrinfo& hint, //
+                 gsl::czstring<> host, gsl::czstring<> serv,
+                 gsl::span<sockaddr_in6> output) noexcept(false)
+    -> frame_future<uint32_t>;
+
+/**
+ * @brief `get_name` with the UDP query for the PTR record
+ * @param serv port number is written. can be `nullptr`
+ * @param flags `NI_NUMERICHOST`, `NI_NAMEREQD`
+ * @return frame_future<uint32_t> 0 or the `EAI_*` error code
+ * @note   `name` and `serv` must live until the result
+ *
+ * Without the record, `name` is the numeric host unless `NI_NAMEREQD`.
+ *
+ * @ingroup Network
+ */
+auto get_name(dns_config config, sockaddr_in addr, //
+              gsl::zstring<NI_MAXHOST> name, gsl::zstring<NI_MAXSERV> serv,
+              int32_t flags = 0) noexcept(false) -> frame_future<uint32_t>;
+auto get_name(dns_config config, sockaddr_in6 addr, //
+              gsl::zstring<NI_MAXHOST> name, gsl::zstring<NI_MAXSERV> serv,
+              int32_t flags = 0) noexcept(false) -> frame_future<uint32_t>;
+
+/**
+ * @brief Race the TCP connections to the addresses(Happy Eyeballs)
+ * @param addrs6 can be empty
+ * @param addrs4 can be empty
+ * @param sd     the connected socket. -1 if all attempts failed
+ * @param delay  the next attempt starts if the previous one is still pending
+ * @param deadline for all attempts
+ * @return frame_future<uint32_t> 0, the error of the last failed attempt,
+ *                                or `EINVAL` if there is no address
+ * @note   `sd` must live until the result. The addresses are copied
+ * @see    https://tools.ietf.org/html/rfc8305
+ *
+ * The attempts start in the order of IPv6, IPv4, IPv6, ... with `delay`.
+ * If an attempt fails, the next one starts without the delay. The first
+ * connected socket wins, and the others are cancelled and closed. So a dead
+ * address costs `delay`, not the timeout of `connect`.
+ *
+ * Each attempt is `connect` with `io_deadline`. Use it in the thread of
+ * `poll_net_tasks`.
+ *
+ * @ingroup Network
+ */
+auto connect_any(gsl::span<const sockaddr_in6> addrs6,
+                 gsl::span<const sockaddr_in> addrs4, int64_t& sd,
+                 std::chrono::milliseconds delay =
+                     std::chrono::milliseconds{250},
+                 std::chrono::steady_clock::time_point deadline =
+                     std::chrono::steady_clock::time_point::max())
+    noexcept(false) -> frame_future<uint32_t>;
+#endif
+
 } // namespace coro
 
 #endif // COROUTINE_NET_IO_H
@@ -56,6 +56,75 @@ class continue_on_pthread final {
     }
 };
 
+class pthread_worker;
+
+/**
+ * @brief Tag to use the parked threads with `pthread_attr_t*`
+ * @ingroup POSIX
+ * @see continue_on_pooled_pthread
+ *
+ * ```cpp
+ * auto work(const pthread_attr_t* attr) -> pthread_joiner {
+ *     co_await pthread_pooled{attr}; // instead of `co_await attr`
+ * }
+ * ```
+ */
+struct pthread_pooled final {
+    const pthread_attr_t* attr = nullptr;
+};
+
+/**
+ * @brief Resume the given coroutine handle on a parked POSIX Thread
+ * @ingroup POSIX
+ * @see continue_on_pthread
+ *
+ * The threads are grouped by their attributes (stack size, guard size,
+ * scheduling, CPU affinity). A new thread is created only when there is no
+ * parked thread in the group. When the coroutine suspends or returns,
+ * the thread is parked again for the next `co_await`.
+ *
+ * The parked threads are never reclaimed. Each group grows to its peak
+ * concurrency and keeps those threads until the process exits.
+ */
+class continue_on_pooled_pthread final {
+    /**
+     * @see pthread_create
+     * @return uint32_t error code of `pthread_create`
+     */
+    static uint32_t submit(pthread_t& tid, pthread_worker*& worker,
+                           uint32_t& ticket, const pthread_attr_t* attr,
+                           coroutine_handle<void> coro) noexcept(false);
+
+  private:
+    pthread_t* const ptr;
+    pthread_worker** const worker;
+    uint32_t* const ticket;
+    const pthread_attr_t* const attr;
+
+  public:
+    bool await_ready() const noexcept {
+        return false;
+    }
+    void await_resume() noexcept {
+    }
+    void await_suspend(coroutine_handle<void> coro) noexcept(false) {
+        if (int ec = submit(*ptr, *worker, *ticket, attr, coro))
+            throw std::system_error{ec, std::system_category(),
+                                    "pthread_create"};
+    }
+
+  public:
+    continue_on_pooled_pthread(pthread_t& tid, pthread_worker*& w,
+                               uint32_t& t, const pthread_attr_t* attr)
+        : ptr{&tid}, worker{&w}, ticket{&t}, attr{attr} {
+    }
+
+    /**
+     * @brief Block until the worker returns from the `ticket`'s resumption
+     */
+    static void wait(pthread_worker* worker, uint32_t ticket) noexcept;
+};
+
 /**
  * @brief allows `pthread_attr_t*` for `co_await` operator 
  * @ingroup Thread
@@ -69,6 +138,9 @@ class continue_on_pthread final {
 class pthread_spawn_promise {
   public:
     pthread_t tid{};
+    // for `pthread_pooled`. the thread is not joinable
+    pthread_worker* worker{};
+    uint32_t ticket{};
 
   public:
     constexpr auto initial_suspend() noexcept {
@@ -94,6 +166,15 @@ class pthread_spawn_promise {
     inline auto await_transform(pthread_attr_t* attr) noexcept(false) {
         return await_transform(static_cast<const pthread_attr_t*>(attr));
     }
+    /**
+     * @brief co_await for `pthread_pooled`
+     */
+    auto await_transform(pthread_pooled pooled) noexcept(false) {
+        if (tid) // already created.
+            throw std::logic_error{"pthread's spawn must be used once"};
+
+        return continue_on_pooled_pthread{tid, worker, ticket, pooled.attr};
+    }
 
     /**
      * @brief general co_await
@@ -108,6 +189,9 @@ class pthread_spawn_promise {
  * @brief Special return type that wraps `pthread_join`
  * @ingroup POSIX
  * @see pthread_join
+ *
+ * For `pthread_pooled`, it waits until the thread returns from the coroutine
+ * since the thread doesn't exit.
  */
 class pthread_joiner final {
     friend class promise_type;
@@ -154,6 +238,8 @@ class pthread_joiner final {
 /**
  * @brief Special return type that wraps `pthread_detach`
  * @ingroup POSIX
+ *
+ * For `pthread_pooled`, there is nothing to detach.
  */
 class pthread_detacher final {
     friend class promise_type;
@@ -10,6 +10,8 @@
 #define COROUTINE_PROMISE_AND_RETURN_TYPES_H
 #include <type_traits>
 
+#include <coroutine/trace.h>
+
 #if __has_include(<coroutine/frame.h>) && !defined(USE_EXPERIMENTAL_COROUTINE)
 #include <coroutine/frame.h>
 
@@ -35,6 +37,17 @@ using std::experimental::suspend_never;
  * Types for easier coroutine promise/return type definition.
  */
 
+/**
+ * @brief Frame address for the trace points of the promise types.
+ *        `coroutine_handle<void>` records the same address
+ * @note  With MSVC, the frame follows the promise. The address is exact
+ *        when the derived promise type doesn't add members
+ */
+template <typename P>
+void* get_frame_address(P& promise) noexcept {
+    return coroutine_handle<P>::from_promise(promise).address();
+}
+
 /**
  * @brief   `suspend_never`(initial) + `suspend_never`(final)
  * @ingroup Return
@@ -46,6 +59,7 @@ class promise_nn {
      * @return suspend_never 
      */
     suspend_never initial_suspend() noexcept {
+        COROUTINE_TRACE_POINT(create, get_frame_address(*this));
         return {};
     }
     /**
@@ -53,6 +67,7 @@ class promise_nn {
      * @return suspend_never 
      */
     suspend_never final_suspend() noexcept {
+        COROUTINE_TRACE_POINT(final, get_frame_address(*this));
         return {};
     }
 };
@@ -68,6 +83,7 @@ class promise_na {
      * @return suspend_never 
      */
     suspend_never initial_suspend() noexcept {
+        COROUTINE_TRACE_POINT(create, get_frame_address(*this));
         return {};
     }
     /**
@@ -75,6 +91,7 @@ class promise_na {
      * @return suspend_always 
      */
     suspend_always final_suspend() noexcept {
+        COROUTINE_TRACE_POINT(final, get_frame_address(*this));
         return {};
     }
 };
@@ -90,6 +107,7 @@ class promise_an {
      * @return suspend_always 
      */
     suspend_always initial_suspend() noexcept {
+        COROUTINE_TRACE_POINT(create, get_frame_address(*this));
         return {};
     }
     /**
@@ -97,6 +115,7 @@ class promise_an {
      * @return suspend_never 
      */
     suspend_never final_suspend() noexcept {
+        COROUTINE_TRACE_POINT(final, get_frame_address(*this));
         return {};
     }
 };
@@ -112,6 +131,7 @@ class promise_aa {
      * @return suspend_always 
      */
     suspend_always initial_suspend() noexcept {
+        COROUTINE_TRACE_POINT(create, get_frame_address(*this));
         return {};
     }
     /**
@@ -119,6 +139,7 @@ class promise_aa {
      * @return suspend_always 
      */
     suspend_always final_suspend() noexcept {
+        COROUTINE_TRACE_POINT(final, get_frame_address(*this));
         return {};
     }
 };
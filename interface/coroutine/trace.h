@@ -0,0 +1,95 @@
+/**
+ * @file coroutine/trace.h
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief Lifecycle tracing of the coroutine frames with Chrome trace export
+ * @copyright CC BY 4.0
+ * @see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ *
+ * The trace points are enabled with the macro `USE_COROUTINE_TRACE`.
+ * Without the macro, `COROUTINE_TRACE_POINT` is an empty expression.
+ */
+#pragma once
+#ifndef COROUTINE_TRACE_H
+#define COROUTINE_TRACE_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @defgroup Trace
+ * Record frame create/resume/suspend/destroy events per thread
+ */
+
+namespace coro {
+
+/**
+ * @brief Kind of the recorded event
+ * @ingroup Trace
+ */
+enum class trace_kind : uint32_t {
+    create = 1,       // `initial_suspend` of the promise
+    resume_begin = 2, // before `coroutine_handle<void>::resume`
+    resume_end = 3,   // the frame is suspended (or returned)
+    final = 4,        // `final_suspend` of the promise
+    destroy = 5,      // before `coroutine_handle<void>::destroy`
+};
+
+/**
+ * @brief 1 event in the thread's ring buffer
+ * @ingroup Trace
+ */
+struct trace_event final {
+    uint64_t timestamp; // nanoseconds from the first record of the process
+    const void* address; // frame address. see `coroutine_handle::address`
+    trace_kind kind;
+};
+
+/**
+ * @brief Append an event to the current thread's ring buffer
+ * @note  The ring buffer is written only by its owner thread.
+ *        If it is full, the oldest events are overwritten.
+ *        If the buffer can't be allocated, the events of the thread are dropped
+ * @ingroup Trace
+ */
+void trace_record(trace_kind kind, const void* address) noexcept;
+
+/**
+ * @brief Write all ring buffers in Chrome `trace_event` JSON format
+ * @param stream output stream. for example, `fopen("trace.json", "w")`
+ * @return size_t number of the written events
+ *
+ * Threads may keep recording while this function is working.
+ * The events overwritten during the dump are dropped, and so are the rest of
+ * a buffer which is reset by `trace_clear` or reused by a new thread.
+ * For an exact capture, call this after the traced work is finished.
+ *
+ * @ingroup Trace
+ */
+size_t trace_dump(std::FILE* stream) noexcept;
+
+/**
+ * @brief Discard the recorded events of all threads
+ * @ingroup Trace
+ *
+ * The buffers are not touched here. Each thread resets its own buffer at its
+ * next record, and `trace_dump` skips the ones which are not reset yet.
+ */
+void trace_clear() noexcept;
+
+/**
+ * @brief Was the `coroutine_portable` module built with `USE_COROUTINE_TRACE`?
+ * @return false `portable_coro_resume`/`portable_coro_destroy` don't record
+ * @ingroup Trace
+ */
+bool trace_is_enabled() noexcept;
+
+} // namespace coro
+
+#if defined(USE_COROUTINE_TRACE)
+#define COROUTINE_TRACE_POINT(kind, addr)                                      \
+    ::coro::trace_record(::coro::trace_kind::kind, addr)
+#else
+#define COROUTINE_TRACE_POINT(kind, addr) static_cast<void>(0)
+#endif
+
+#endif // COROUTINE_TRACE_H
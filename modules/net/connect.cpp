@@ -0,0 +1,170 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `connect_any` races the connections to the resolved addresses
+ * @see    https://tools.ietf.org/html/rfc8305
+ */
+#include "timer_wheel.h"
+
+#include <system_error>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace coro {
+
+/**
+ * @brief The address of an attempt
+ */
+struct connect_target final {
+    union {
+        sockaddr_in in4;
+        sockaddr_in6 in6;
+    };
+    int family = AF_UNSPEC;
+};
+
+/**
+ * @brief Shared state of the attempts. Lives in the frame of `connect_any`
+ */
+struct connect_race final {
+    io_cancel_token losers{};
+    steady_clock::time_point deadline{};
+    int64_t winner = -1;
+    uint32_t errc = 0; // the last failure
+    uint32_t running = 0;
+    uint32_t finished = 0; // not observed by the waiter yet
+    io_timer timer{};
+    coroutine_handle<void> waiter{};
+
+    /**
+     * @brief Resume `connect_any` if it is waiting
+     */
+    void notify() noexcept(false) {
+        ++finished;
+        if (waiter == nullptr)
+            return;
+        timer.cancel();
+        exchange(waiter, nullptr).resume();
+    }
+};
+
+/**
+ * @brief Wait for the end of an attempt, or the time point
+ */
+class connect_race_wait final {
+    connect_race& race;
+    const steady_clock::time_point until;
+
+  public:
+    connect_race_wait(connect_race& _race,
+                      steady_clock::time_point _until) noexcept
+        : race{_race}, until{_until} {
+    }
+    bool await_ready() const noexcept {
+        return race.finished || until <= steady_clock::now();
+    }
+    void await_suspend(coroutine_handle<void> coro) noexcept {
+        race.waiter = coro;
+        if (until == steady_clock::time_point::max())
+            return;
+        race.timer.expiry = timer_wheel::to_tick(until);
+        race.timer.task = coro;
+        get_timer_wheel().insert(race.timer);
+    }
+    void await_resume() noexcept {
+        race.timer.cancel();
+        race.waiter = nullptr;
+        race.finished = 0;
+    }
+};
+
+/**
+ * @brief Connect to the target. The loser closes its socket
+ */
+static auto attempt(connect_race& race, connect_target target) -> null_frame_t {
+    ++race.running;
+    io_work_t work{};
+    uint32_t errc = 0;
+    const int64_t sd =
+        socket(target.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    try {
+        if (sd < 0)
+            errc = static_cast<uint32_t>(errno);
+        else if (target.family == AF_INET6) {
+            co_await connect(sd, target.in6, work, race.deadline,
+                             &race.losers);
+            errc = work.error();
+        } else {
+            co_await connect(sd, target.in4, work, race.deadline,
+                             &race.losers);
+            errc = work.error();
+        }
+    } catch (const system_error& e) {
+        errc = static_cast<uint32_t>(e.code().value());
+    }
+    --race.running;
+    if (errc == 0 && race.winner < 0) {
+        race.winner = sd;
+    } else {
+        if (errc != 0 && errc != ECANCELED)
+            race.errc = errc;
+        if (sd >= 0) {
+            unregister_socket(sd);
+            close(sd);
+        }
+    }
+    race.notify(); // `race` may be gone after this
+}
+
+auto connect_any(gsl::span<const sockaddr_in6> addrs6,
+                 gsl::span<const sockaddr_in> addrs4, int64_t& sd,
+                 milliseconds delay,
+                 steady_clock::time_point deadline) noexcept(false)
+    -> frame_future<uint32_t> {
+    sd = -1;
+    // interleave the families. IPv6 first
+    vector<connect_target> targets{};
+    targets.reserve(static_cast<size_t>(addrs6.size() + addrs4.size()));
+    for (ptrdiff_t i = 0; i < addrs6.size() || i < addrs4.size(); ++i) {
+        connect_target target{};
+        if (i < addrs6.size()) {
+            target.in6 = addrs6[i];
+            target.family = AF_INET6;
+            targets.emplace_back(target);
+        }
+        if (i < addrs4.size()) {
+            target.in4 = addrs4[i];
+            target.family = AF_INET;
+            targets.emplace_back(target);
+        }
+    }
+    if (targets.empty())
+        co_return EINVAL;
+
+    connect_race race{};
+    race.deadline = deadline;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        attempt(race, targets[i]);
+        if (race.winner >= 0 || i + 1 == targets.size())
+            break;
+        // the next one starts after the delay, or when an attempt failed
+        co_await connect_race_wait{race,
+                                   min(steady_clock::now() + delay, deadline)};
+        if (race.winner >= 0 || deadline <= steady_clock::now())
+            break;
+    }
+    while (race.winner < 0 && race.running > 0)
+        co_await connect_race_wait{race, steady_clock::time_point::max()};
+
+    // with epoll, the losers are resumed here. with io_uring, in the poll
+    race.losers.cancel();
+    while (race.running > 0)
+        co_await connect_race_wait{race, steady_clock::time_point::max()};
+    sd = race.winner;
+    if (sd >= 0)
+        co_return 0;
+    co_return race.errc ? race.errc : ETIMEDOUT;
+}
+
+} // namespace coro
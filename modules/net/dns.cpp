@@ -0,0 +1,729 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  UDP DNS client on `send_to`/`recv_from` for the async `get_address`
+ */
+#include <coroutine/net.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace coro {
+
+constexpr uint16_t dns_port = 53;
+constexpr size_t dns_header_size = 12;
+constexpr uint16_t dns_class_in = 1;
+constexpr uint16_t dns_type_a = 1;
+constexpr uint16_t dns_type_ptr = 12;
+constexpr uint16_t dns_type_aaaa = 28;
+
+/**
+ * @brief Query or answer without EDNS. 512 bytes at most
+ */
+struct dns_message final {
+    array<std::byte, 512> bytes{};
+    size_t length = 0;
+};
+
+static uint16_t read_u16(const std::byte* p) noexcept {
+    return static_cast<uint16_t>((to_integer<uint16_t>(p[0]) << 8) |
+                                 to_integer<uint16_t>(p[1]));
+}
+
+static uint32_t read_u32(const std::byte* p) noexcept {
+    return (static_cast<uint32_t>(read_u16(p)) << 16) | read_u16(p + 2);
+}
+
+static void write_u16(std::byte* p, uint16_t v) noexcept {
+    p[0] = static_cast<std::byte>(v >> 8);
+    p[1] = static_cast<std::byte>(v & 0xFF);
+}
+
+/**
+ * @return false The name is empty or too long, or has an empty label
+ */
+static bool make_query(dns_message& query, uint16_t id,
+                       gsl::czstring<> name, uint16_t type) noexcept {
+    auto* p = query.bytes.data();
+    memset(p, 0, dns_header_size);
+    write_u16(p, id);
+    write_u16(p + 2, 0x0100); // recursion desired
+    write_u16(p + 4, 1);      // 1 question
+    size_t pos = dns_header_size;
+    auto length = strlen(name);
+    if (length && name[length - 1] == '.')
+        --length;
+    if (length == 0 || length > 253)
+        return false;
+    for (size_t begin = 0; begin <= length;) {
+        auto end = begin;
+        while (end < length && name[end] != '.')
+            ++end;
+        const auto label = end - begin;
+        if (label == 0 || label > 63)
+            return false;
+        p[pos++] = static_cast<std::byte>(label);
+        memcpy(p + pos, name + begin, label);
+        pos += label;
+        begin = end + 1;
+    }
+    p[pos++] = std::byte{0};
+    write_u16(p + pos, type);
+    write_u16(p + pos + 2, dns_class_in);
+    query.length = pos + 4;
+    return true;
+}
+
+/**
+ * @return size_t The position after the name. 0 if it is broken
+ */
+static size_t skip_name(const dns_message& m, size_t pos) noexcept {
+    while (pos < m.length) {
+        const auto len = to_integer<uint8_t>(m.bytes[pos]);
+        if (len == 0)
+            return pos + 1;
+        if ((len & 0xC0) == 0xC0) // compression pointer
+            return pos + 2 <= m.length ? pos + 2 : 0;
+        pos += 1 + len;
+    }
+    return 0;
+}
+
+/**
+ * @brief Expand the compressed name to the dotted string
+ * @return false The name is broken or longer than the capacity
+ */
+static bool read_name(const dns_message& m, size_t pos, char* name,
+                      size_t capacity) noexcept {
+    size_t used = 0;
+    for (auto hops = 0; pos < m.length && hops < 64;) {
+        const auto len = to_integer<uint8_t>(m.bytes[pos]);
+        if (len == 0) {
+            if (used == 0)
+                return false;
+            name[used - 1] = '\0'; // replace the last '.'
+            return true;
+        }
+        if ((len & 0xC0) == 0xC0) {
+            if (pos + 2 > m.length)
+                return false;
+            pos = read_u16(m.bytes.data() + pos) & 0x3FFF;
+            ++hops;
+            continue;
+        }
+        if (pos + 1 + len > m.length || used + len + 1 > capacity)
+            return false;
+        memcpy(name + used, m.bytes.data() + pos + 1, len);
+        used += len;
+        name[used++] = '.';
+        pos += 1 + len;
+    }
+    return false;
+}
+
+/**
+ * @brief Invoke `fn(offset, length, ttl)` for the data of the matching records
+ * @return uint32_t 0, or the `EAI_*` error code for the response
+ */
+template <typename Fn>
+static uint32_t read_records(const dns_message& m, uint16_t type,
+                             Fn&& fn) noexcept {
+    const auto* p = m.bytes.data();
+    if (m.length < dns_header_size)
+        return EAI_FAIL;
+    const auto flags = read_u16(p + 2);
+    if ((flags & 0x8000) == 0 || (flags & 0x0200)) // not a response, truncated
+        return EAI_FAIL;
+    switch (flags & 0x000F) {
+    case 0:
+        break;
+    case 2: // server failure
+        return EAI_AGAIN;
+    case 3: // no such name
+        return EAI_NONAME;
+    default:
+        return EAI_FAIL;
+    }
+    size_t pos = dns_header_size;
+    for (auto i = read_u16(p + 4); i; --i) {
+        pos = skip_name(m, pos);
+        if (pos == 0 || pos + 4 > m.length)
+            return EAI_FAIL;
+        pos += 4; // type, class
+    }
+    uint32_t count = 0;
+    for (auto i = read_u16(p + 6); i; --i) {
+        pos = skip_name(m, pos);
+        if (pos == 0 || pos + 10 > m.length)
+            return EAI_FAIL;
+        const auto rtype = read_u16(p + pos);
+        const auto rclass = read_u16(p + pos + 2);
+        const auto ttl = read_u32(p + pos + 4);
+        const auto rdlength = read_u16(p + pos + 8);
+        pos += 10;
+        if (pos + rdlength > m.length)
+            return EAI_FAIL;
+        // the others like CNAME are followed by the records of the target
+        if (rtype == type && rclass == dns_class_in) {
+            fn(pos, rdlength, ttl);
+            ++count;
+        }
+        pos += rdlength;
+    }
+    return count ? 0 : EAI_NONAME;
+}
+
+static uint16_t make_query_id() noexcept {
+    thread_local minstd_rand engine{random_device{}()};
+    return static_cast<uint16_t>(engine());
+}
+
+/**
+ * @brief Send the query and receive the answer of the same id
+ * @return frame_future<uint32_t> 0, or `EAI_AGAIN` if there is no answer
+ */
+static auto exchange_message(dns_config config, const dns_message& query,
+                             dns_message& answer) noexcept(false)
+    -> frame_future<uint32_t> {
+    const auto sd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                           IPPROTO_UDP);
+    if (sd < 0)
+        co_return EAI_SYSTEM;
+    auto on_return = gsl::finally([sd]() {
+        unregister_socket(sd);
+        close(sd);
+    });
+    const auto id = read_u16(query.bytes.data());
+    const auto message = io_buffer_t{const_cast<std::byte*>(query.bytes.data()),
+                                     gsl::narrow_cast<ptrdiff_t>(query.length)};
+    io_work_t work{};
+    for (auto i = 0u; i < config.attempts; ++i) {
+        const auto deadline = steady_clock::now() + config.timeout;
+        co_await send_to(sd, config.server, message, work, deadline);
+        if (work.error() == ETIMEDOUT)
+            continue;
+        if (work.error())
+            co_return EAI_SYSTEM;
+        while (true) {
+            sockaddr_in remote{};
+            const auto sz =
+                co_await recv_from(sd, remote, answer.bytes, work, deadline);
+            if (work.error() == ETIMEDOUT)
+                break; // try again
+            if (sz < 0)
+                co_return EAI_SYSTEM;
+            // ignore the others. they may be late or forged
+            if (remote.sin_addr.s_addr != config.server.sin_addr.s_addr ||
+                remote.sin_port != config.server.sin_port ||
+                static_cast<size_t>(sz) < dns_header_size ||
+                read_u16(answer.bytes.data()) != id)
+                continue;
+            answer.length = static_cast<size_t>(sz);
+            co_return 0;
+        }
+    }
+    co_return EAI_AGAIN;
+}
+
+/**
+ * @return uint32_t 0, or `EAI_SERVICE` if it is not a port number
+ */
+static uint32_t parse_port(gsl::czstring<> serv, uint16_t& port) noexcept {
+    port = 0;
+    if (serv == nullptr)
+        return 0;
+    char* end = nullptr;
+    const auto value = strtoul(serv, &end, 10);
+    if (end == serv || *end != '\0' || value > UINT16_MAX)
+        return EAI_SERVICE;
+    port = htons(static_cast<uint16_t>(value));
+    return 0;
+}
+
+uint32_t load_dns_config(dns_config& config, gsl::czstring<> path) noexcept {
+    auto* file = fopen(path, "r");
+    if (file == nullptr)
+        return EAI_SYSTEM;
+    auto on_return = gsl::finally([file]() { fclose(file); });
+    char line[256]{};
+    char address[INET_ADDRSTRLEN]{};
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, " nameserver %15s", address) != 1)
+            continue;
+        sockaddr_in server{};
+        if (inet_pton(AF_INET, address, &server.sin_addr) != 1)
+            continue; // IPv6 name server is not supported
+        server.sin_family = AF_INET;
+        server.sin_port = htons(dns_port);
+        config.server = server;
+        return 0;
+    }
+    return EAI_FAIL;
+}
+
+/**
+ * @brief Member access of `sockaddr_in`/`sockaddr_in6` for the records
+ */
+template <typename T>
+struct dns_record_of;
+
+template <>
+struct dns_record_of<sockaddr_in> final {
+    static constexpr int family = AF_INET;
+    static constexpr uint16_t type = dns_type_a;
+    static constexpr uint16_t length = 4;
+
+    static void prepare(sockaddr_in& addr, uint16_t port) noexcept {
+        addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = port;
+    }
+    static void* host(sockaddr_in& addr) noexcept {
+        return &addr.sin_addr;
+    }
+};
+
+template <>
+struct dns_record_of<sockaddr_in6> final {
+    static constexpr int family = AF_INET6;
+    static constexpr uint16_t type = dns_type_aaaa;
+    static constexpr uint16_t length = 16;
+
+    static void prepare(sockaddr_in6& addr, uint16_t port) noexcept {
+        addr = {};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = port;
+    }
+    static void* host(sockaddr_in6& addr) noexcept {
+        return &addr.sin6_addr;
+    }
+};
+
+union dns_address {
+    sockaddr_in in4;
+    sockaddr_in6 in6;
+};
+
+static void load(const dns_address& a, sockaddr_in& addr) noexcept {
+    addr = a.in4;
+}
+static void load(const dns_address& a, sockaddr_in6& addr) noexcept {
+    addr = a.in6;
+}
+static void store(dns_address& a, const sockaddr_in& addr) noexcept {
+    a.in4 = addr;
+}
+static void store(dns_address& a, const sockaddr_in6& addr) noexcept {
+    a.in6 = addr;
+}
+
+/**
+ * @brief The answer of the query. Negative one has the error code
+ */
+struct dns_cache::entry final {
+    steady_clock::time_point expiry{};
+    uint32_t errc = 0;
+    vector<dns_address> addresses{};
+};
+
+/**
+ * @brief Immutable snapshot of the entries. Replaced by the writer
+ */
+struct dns_cache::table final {
+    unordered_map<string, entry> entries{};
+};
+
+/**
+ * @brief The query in flight. The followers wait for its result
+ */
+struct dns_cache::pending final {
+    vector<coroutine_handle<void>> followers{};
+    entry result{};
+};
+
+/**
+ * @brief The state for the writers of the cache
+ */
+struct dns_cache::writer final {
+    mutex mtx{};
+    // the readers may be using them. with the bits of the `readers` slots
+    // which are not seen 0 after the retirement
+    vector<pair<const table*, uint32_t>> retired{};
+    unordered_map<string, pending*> inflight{};
+};
+
+dns_cache::dns_cache(seconds _negative_ttl, seconds _max_ttl,
+                     size_t _capacity) noexcept(false)
+    : current{new table{}}, state{make_unique<writer>()},
+      negative_ttl{_negative_ttl}, max_ttl{_max_ttl}, capacity{_capacity} {
+}
+
+dns_cache::~dns_cache() noexcept {
+    for (auto& [t, slots] : state->retired)
+        delete t;
+    delete current.load();
+}
+
+size_t dns_cache::size() noexcept {
+    uint32_t slot = 0;
+    const auto* t = acquire(slot);
+    auto on_return = gsl::finally([this, slot]() { release(slot); });
+    const auto now = steady_clock::now();
+    size_t count = 0;
+    for (const auto& [key, item] : t->entries)
+        if (item.expiry > now)
+            ++count;
+    return count;
+}
+
+auto dns_cache::acquire(uint32_t& slot) noexcept -> const table* {
+    // count in the slot of the epoch. retry if the writer moved it
+    while (true) {
+        slot = epoch.load(memory_order_seq_cst) & 1;
+        readers[slot].fetch_add(1, memory_order_seq_cst);
+        if ((epoch.load(memory_order_seq_cst) & 1) == slot)
+            return current.load(memory_order_seq_cst);
+        readers[slot].fetch_sub(1, memory_order_seq_cst);
+    }
+}
+
+void dns_cache::release(uint32_t slot) noexcept {
+    if (readers[slot].fetch_sub(1, memory_order_seq_cst) != 1)
+        return;
+    // the last reader of the previous epoch. the retired may be deleted now.
+    // the readers of the current epoch don't touch the writer
+    if ((epoch.load(memory_order_seq_cst) & 1) == slot)
+        return;
+    if (state->mtx.try_lock() == false)
+        return; // the writer will do
+    reclaim();
+    state->mtx.unlock();
+}
+
+void dns_cache::reclaim() noexcept {
+    // requires the lock of the writer
+    uint32_t drained = 0;
+    for (auto slot = 0u; slot < 2; ++slot)
+        if (readers[slot].load(memory_order_seq_cst) == 0)
+            drained |= 1u << slot;
+    // a reader of the retired one is counted in a slot until its release
+    auto& retired = state->retired;
+    for (auto& [t, slots] : retired) {
+        slots &= ~drained;
+        if (slots == 0)
+            delete t;
+    }
+    retired.erase(remove_if(retired.begin(), retired.end(),
+                            [](const auto& r) { return r.second == 0; }),
+                  retired.end());
+}
+
+bool dns_cache::find(const string& key, entry& output) noexcept(false) {
+    uint32_t slot = 0;
+    const auto* t = acquire(slot);
+    auto on_return = gsl::finally([this, slot]() { release(slot); });
+    const auto it = t->entries.find(key);
+    if (it == t->entries.end() || it->second.expiry <= steady_clock::now())
+        return false;
+    output = it->second;
+    return true;
+}
+
+void dns_cache::insert(const string& key, const entry& item) noexcept(false) {
+    // requires the lock of the writer
+    const auto now = steady_clock::now();
+    auto next = make_unique<table>();
+    for (const auto& [k, v] : current.load(memory_order_relaxed)->entries)
+        if (v.expiry > now)
+            next->entries.emplace(k, v);
+    if (next->entries.size() >= capacity) {
+        // evict the one which expires first
+        auto victim = next->entries.begin();
+        for (auto it = next->entries.begin(); it != next->entries.end(); ++it)
+            if (it->second.expiry < victim->second.expiry)
+                victim = it;
+        next->entries.erase(victim);
+    }
+    next->entries[key] = item;
+    state->retired.reserve(state->retired.size() + 1);
+
+    const auto* prev = current.exchange(next.release(), memory_order_seq_cst);
+    state->retired.emplace_back(prev, 0b11);
+    // the new readers use the other slot, so the current one can drain
+    epoch.fetch_add(1, memory_order_seq_cst);
+    reclaim();
+}
+
+/**
+ * @brief Wait for the same query in flight, or start it
+ *
+ * The first one becomes the leader. It must call `finish` with its result.
+ * The others are resumed by the leader with the `pending::result`.
+ */
+class dns_cache::join_awaitable final {
+    dns_cache& cache;
+    const string& key;
+    pending& leader;
+    pending* followed = nullptr;
+
+  public:
+    join_awaitable(dns_cache& _cache, const string& _key,
+                   pending& _leader) noexcept
+        : cache{_cache}, key{_key}, leader{_leader} {
+    }
+    bool await_ready() noexcept {
+        return false;
+    }
+    bool await_suspend(coroutine_handle<void> coro) noexcept(false) {
+        unique_lock lck{cache.state->mtx};
+        auto it = cache.state->inflight.find(key);
+        if (it == cache.state->inflight.end()) {
+            cache.state->inflight.emplace(key, &leader);
+            return false;
+        }
+        followed = it->second;
+        followed->followers.emplace_back(coro);
+        return true;
+    }
+    /**
+     * @return pending* the result of the leader. `nullptr` for the leader
+     */
+    pending* await_resume() noexcept {
+        return followed;
+    }
+};
+
+void dns_cache::finish(const string& key, pending& leader) noexcept(false) {
+    vector<coroutine_handle<void>> followers{};
+    // resume them after the unlock, even if `insert` throws
+    auto on_return = gsl::finally([&followers]() {
+        for (auto coro : followers)
+            coro.resume();
+    });
+    unique_lock lck{state->mtx};
+    followers.swap(leader.followers);
+    state->inflight.erase(key);
+    const auto& result = leader.result;
+    if (result.expiry > steady_clock::now())
+        insert(key, result);
+}
+
+/**
+ * @brief Cache key from the arguments and the record type
+ */
+template <typename T>
+static auto make_key(const addrinfo& hint, gsl::czstring<> host,
+                     gsl::czstring<> serv) noexcept(false) -> string {
+    const int32_t fields[] = {dns_record_of<T>::type, hint.ai_flags,
+                              hint.ai_socktype, hint.ai_protocol};
+    string key{host};
+    key += '\0';
+    if (serv)
+        key += serv;
+    key += '\0';
+    key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    return key;
+}
+
+/**
+ * @brief The async `get_address` with `dns_cache`
+ */
+struct dns_client final {
+    using entry = dns_cache::entry;
+    using pending = dns_cache::pending;
+
+    template <typename T>
+    static uint32_t copy_result(const entry& item,
+                                gsl::span<T> output) noexcept {
+        ptrdiff_t i = 0;
+        for (const auto& addr : item.addresses) {
+            if (i == output.size())
+                break;
+            load(addr, output[i++]);
+        }
+        return item.errc;
+    }
+
+    /**
+     * @brief Query and parse the records into the entry
+     */
+    template <typename T>
+    static auto query_address(dns_config config, gsl::czstring<> host,
+                              uint16_t port, entry& result) noexcept(false)
+        -> frame_future<uint32_t> {
+        using record = dns_record_of<T>;
+        dns_message query{}, answer{};
+        uint32_t ec = EAI_NONAME;
+        if (make_query(query, make_query_id(), host, record::type))
+            ec = co_await exchange_message(config, query, answer);
+        uint32_t ttl = UINT32_MAX;
+        const auto on_record = [&](size_t pos, uint16_t length, uint32_t t) {
+            if (length != record::length)
+                return;
+            T item{};
+            record::prepare(item, port);
+            memcpy(record::host(item), &answer.bytes[pos], length);
+            dns_address addr{};
+            store(addr, item);
+            result.addresses.emplace_back(addr);
+            ttl = min(ttl, t);
+        };
+        if (ec == 0)
+            ec = read_records(answer, record::type, on_record);
+        result.errc = ec;
+        if (config.cache == nullptr)
+            co_return ec;
+        // the other errors are not cached. their expiry is 0
+        const auto now = steady_clock::now();
+        if (ec == 0)
+            result.expiry = now + min(seconds{ttl}, config.cache->max_ttl);
+        else if (ec == EAI_NONAME)
+            result.expiry = now + config.cache->negative_ttl;
+        co_return ec;
+    }
+
+    template <typename T>
+    static auto resolve(dns_config config, const addrinfo& hint,
+                        gsl::czstring<> host, gsl::czstring<> serv,
+                        gsl::span<T> output) noexcept(false)
+        -> frame_future<uint32_t> {
+        using record = dns_record_of<T>;
+        if (hint.ai_family != AF_UNSPEC && hint.ai_family != record::family)
+            co_return EAI_FAMILY;
+        uint16_t port = 0;
+        if (const auto ec = parse_port(serv, port))
+            co_return ec;
+        if (host == nullptr)
+            co_return EAI_NONAME;
+        T addr{};
+        record::prepare(addr, port);
+        if (inet_pton(record::family, host, record::host(addr)) == 1) {
+            if (output.empty() == false)
+                output[0] = addr;
+            co_return 0;
+        }
+        if (hint.ai_flags & AI_NUMERICHOST)
+            co_return EAI_NONAME;
+
+        entry result{};
+        if (config.cache == nullptr) {
+            co_await query_address<T>(config, host, port, result);
+            co_return copy_result(result, output);
+        }
+        auto& cache = *config.cache;
+        const auto key = make_key<T>(hint, host, serv);
+        if (cache.find(key, result)) // without lock
+            co_return copy_result(result, output);
+
+        pending leader{};
+        if (auto* followed =
+                co_await dns_cache::join_awaitable{cache, key, leader})
+            co_return copy_result(followed->result, output);
+        try {
+            co_await query_address<T>(config, host, port, leader.result);
+        } catch (...) {
+            leader.result = {}; // not cached
+            leader.result.errc = EAI_MEMORY;
+        }
+        cache.finish(key, leader);
+        co_return copy_result(leader.result, output);
+    }
+};
+
+auto get_address(dns_config config, const addrinfo& hint, //
+                 gsl::czstring<> host, gsl::czstring<> serv,
+                 gsl::span<sockaddr_in> output) noexcept(false)
+    -> frame_future<uint32_t> {
+    return dns_client::resolve(config, hint, host, serv, output);
+}
+
+auto get_address(dns_config config, const addrinfo& hint, //
+                 gsl::czstring<> host, gsl::czstring<> serv,
+                 gsl::span<sockaddr_in6> output) noexcept(false)
+    -> frame_future<uint32_t> {
+    return dns_client::resolve(config, hint, host, serv, output);
+}
+
+/**
+ * @brief Query the `PTR` record of the reverse name
+ * @param numeric used when there is no record and `NI_NAMEREQD` is not set
+ */
+static auto query_name(dns_config config, const char* reverse,
+                       const char* numeric, gsl::zstring<NI_MAXHOST> name,
+                       int32_t flags) noexcept(false)
+    -> frame_future<uint32_t> {
+    dns_message query{}, answer{};
+    uint32_t ec = EAI_NONAME;
+    if (make_query(query, make_query_id(), reverse, dns_type_ptr))
+        ec = co_await exchange_message(config, query, answer);
+    if (ec == 0) {
+        bool found = false;
+        ec = read_records(answer, dns_type_ptr,
+                          [&](size_t pos, uint16_t, uint32_t) {
+                              if (found == false)
+                                  found = read_name(answer, pos, name,
+                                                    NI_MAXHOST);
+                          });
+        if (ec == 0 && found == false)
+            ec = EAI_NONAME;
+    }
+    if (ec == EAI_NONAME && (flags & NI_NAMEREQD) == 0) {
+        strncpy(name, numeric, NI_MAXHOST);
+        co_return 0;
+    }
+    co_return ec;
+}
+
+auto get_name(dns_config config, sockaddr_in addr, //
+              gsl::zstring<NI_MAXHOST> name, gsl::zstring<NI_MAXSERV> serv,
+              int32_t flags) noexcept(false) -> frame_future<uint32_t> {
+    if (serv)
+        snprintf(serv, NI_MAXSERV, "%u", ntohs(addr.sin_port));
+    char numeric[INET_ADDRSTRLEN]{};
+    inet_ntop(AF_INET, &addr.sin_addr, numeric, sizeof(numeric));
+    if (flags & NI_NUMERICHOST) {
+        strncpy(name, numeric, NI_MAXHOST);
+        co_return 0;
+    }
+    const auto* b = reinterpret_cast<const uint8_t*>(&addr.sin_addr);
+    char reverse[32]{};
+    snprintf(reverse, sizeof(reverse), "%u.%u.%u.%u.in-addr.arpa", b[3], b[2],
+             b[1], b[0]);
+    co_return co_await query_name(config, reverse, numeric, name, flags);
+}
+
+auto get_name(dns_config config, sockaddr_in6 addr, //
+              gsl::zstring<NI_MAXHOST> name, gsl::zstring<NI_MAXSERV> serv,
+              int32_t flags) noexcept(false) -> frame_future<uint32_t> {
+    if (serv)
+        snprintf(serv, NI_MAXSERV, "%u", ntohs(addr.sin6_port));
+    char numeric[INET6_ADDRSTRLEN]{};
+    inet_ntop(AF_INET6, &addr.sin6_addr, numeric, sizeof(numeric));
+    if (flags & NI_NUMERICHOST) {
+        strncpy(name, numeric, NI_MAXHOST);
+        co_return 0;
+    }
+    // nibbles in the reverse order. "b.a.9.8. ... .ip6.arpa"
+    const auto* b = reinterpret_cast<const uint8_t*>(&addr.sin6_addr);
+    constexpr auto digits = "0123456789abcdef";
+    char reverse[80]{};
+    auto* p = reverse;
+    for (auto i = 15; i >= 0; --i) {
+        *p++ = digits[b[i] & 0xF];
+        *p++ = '.';
+        *p++ = digits[b[i] >> 4];
+        *p++ = '.';
+    }
+    strcpy(p, "ip6.arpa");
+    co_return co_await query_name(config, reverse, numeric, name, flags);
+}
+
+} // namespace coro
@@ -77,7 +77,11 @@ auto send_to(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buffer,
     return *reinterpret_cast<io_send_to*>(addressof(work));
 }
 
-void io_send_to::suspend(coroutine_handle<void> rh) noexcept(false) {
+bool io_send_to::ready() noexcept {
+    return io_work_t::ready();
+}
+
+bool io_send_to::suspend(coroutine_handle<void> rh) noexcept(false) {
     static_assert(sizeof(void*) <= sizeof(uint64_t));
     task = rh;
 
@@ -91,6 +95,7 @@ void io_send_to::suspend(coroutine_handle<void> rh) noexcept(false) {
     req.udata = reinterpret_cast<uint64_t>(static_cast<io_work_t*>(this));
 
     netkq.change(req);
+    return true;
 }
 
 int64_t io_send_to::resume() noexcept {
@@ -121,7 +126,11 @@ auto recv_from(uint64_t sd, sockaddr_in6& remote, io_buffer_t buffer,
     return *reinterpret_cast<io_recv_from*>(addressof(work));
 }
 
-void io_recv_from::suspend(coroutine_handle<void> rh) noexcept(false) {
+bool io_recv_from::ready() noexcept {
+    return io_work_t::ready();
+}
+
+bool io_recv_from::suspend(coroutine_handle<void> rh) noexcept(false) {
     static_assert(sizeof(void*) <= sizeof(uint64_t));
 
     task = rh;
@@ -139,6 +148,7 @@ void io_recv_from::suspend(coroutine_handle<void> rh) noexcept(false) {
     req.udata = reinterpret_cast<uint64_t>(static_cast<io_work_t*>(this));
 
     netkq.change(req);
+    return true;
 }
 
 int64_t io_recv_from::resume() noexcept {
@@ -161,7 +171,11 @@ auto send_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
     return *reinterpret_cast<io_send*>(addressof(work));
 }
 
-void io_send::suspend(coroutine_handle<void> rh) noexcept(false) {
+bool io_send::ready() noexcept {
+    return io_work_t::ready();
+}
+
+bool io_send::suspend(coroutine_handle<void> rh) noexcept(false) {
     static_assert(sizeof(void*) <= sizeof(uint64_t));
     task = rh;
 
@@ -175,6 +189,7 @@ void io_send::suspend(coroutine_handle<void> rh) noexcept(false) {
     req.udata = reinterpret_cast<uint64_t>(static_cast<io_work_t*>(this));
 
     netkq.change(req);
+    return true;
 }
 
 int64_t io_send::resume() noexcept {
@@ -195,7 +210,11 @@ auto recv_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
     return *reinterpret_cast<io_recv*>(addressof(work));
 }
 
-void io_recv::suspend(coroutine_handle<void> rh) noexcept(false) {
+bool io_recv::ready() noexcept {
+    return io_work_t::ready();
+}
+
+bool io_recv::suspend(coroutine_handle<void> rh) noexcept(false) {
     static_assert(sizeof(void*) <= sizeof(uint64_t));
 
     task = rh;
@@ -209,6 +228,7 @@ void io_recv::suspend(coroutine_handle<void> rh) noexcept(false) {
     req.udata = reinterpret_cast<uint64_t>(static_cast<io_work_t*>(this));
 
     netkq.change(req);
+    return true;
 }
 
 int64_t io_recv::resume() noexcept {
@@ -1,44 +1,737 @@
 /**
  * @author github.com/luncliff (luncliff@gmail.com)
  */
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 
 #include <coroutine/linux.h>
 #include <coroutine/net.h>
 
+#include "timer_wheel.h"
+#include "uring.h"
+
 static_assert(sizeof(ssize_t) <= sizeof(int64_t));
 using namespace std;
 using namespace std::chrono;
 
 namespace coro {
 
-epoll_owner iep{}, oep{}; // inbound, outbound
+//
+//  `io_work_t::internal` is [flag:32][errc:32] like the `OVERLAPPED`.
+//  The flag is `int32_t`, so its sign bit marks the work completed
+//  without suspension (or by io_uring). Then `internal_high` is the result
+//
+constexpr uint64_t errc_mask = 0xFFFF'FFFF;
+constexpr uint64_t completed_mask = uint64_t{1} << 63;
+
+static uint32_t get_flag(const io_work_t& work) noexcept {
+    return static_cast<uint32_t>((work.internal & ~completed_mask) >> 32);
+}
+static void set_error(io_work_t& work, uint32_t errc) noexcept {
+    work.internal = (work.internal & ~errc_mask) | errc;
+}
+
+/**
+ * @brief Save the result of the operation for `resume`
+ */
+static void complete(io_work_t& work, int64_t sz, uint32_t errc) noexcept {
+    set_error(work, errc);
+    work.internal |= completed_mask;
+    work.internal_high = static_cast<uint64_t>(sz);
+}
+
+/**
+ * @return true The work is completed. `sz` is the result
+ */
+static bool take_completion(io_work_t& work, int64_t& sz) noexcept {
+    if ((work.internal & completed_mask) == 0)
+        return false;
+    work.internal &= ~completed_mask;
+    sz = static_cast<int64_t>(work.internal_high);
+    return true;
+}
+
+/**
+ * @brief epoll instance and event buffer of the thread
+ *
+ * A socket is bound to the reactor of the thread that awaited it first.
+ * Its coroutines are resumed in `poll_net_tasks` of that thread
+ * until `migrate_socket`.
+ */
+struct io_reactor final {
+    epoll_owner ep{}; // both inbound and outbound
+    // grows when it is filled by 1 wait
+    vector<epoll_event> events = vector<epoll_event>(64);
+};
+
+static thread_local io_reactor reactor{};
+
+/**
+ * @brief Persistent registration of a socket in the `io_reactor`
+ *
+ * The socket is added with `EPOLLET` once, for both directions. Each
+ * direction has a slot: 0, `ready`, or the address of the waiting coroutine.
+ * So after the first I/O, the suspension is a CAS on the slot.
+ *
+ * `ready` means there was no `EAGAIN` after the last event.
+ * The operation is tried before it parks the coroutine in the slot.
+ * A slot with `deferred` bit holds `io_work_t*`. Its operation is performed
+ * by the reactor, then the coroutine is resumed. See `io_send_zerocopy`.
+ */
+struct io_registration final {
+    static constexpr uintptr_t ready = 1;
+    static constexpr uintptr_t deferred = 2;
+    static constexpr uint32_t unregistered = 0, registering = 1,
+                              registered = 2;
+    // cache of `SO_ZEROCOPY`. `unknown` if it is not tried yet
+    static constexpr uint32_t unknown = 0, zerocopy_on = 1, zerocopy_off = 2;
+
+    atomic<uintptr_t> reader{}, writer{};
+    atomic<uint32_t> state{};
+    atomic<epoll_owner*> owner{}; // `io_reactor::ep`
+    int64_t handle = -1;
+    atomic<uint64_t> inode{}; // the socket which is registered. see `fstat`
+
+    atomic<uint32_t> zerocopy{};
+    // `MSG_ZEROCOPY` sends and their notifications. The kernel numbers the
+    // sends of the socket from 0, and a notification reports a range of them
+    atomic<uint32_t> zerocopy_sent{}, zerocopy_done{};
+    atomic<uintptr_t> notified{}; // the coroutine waits for the notification
+};
+
+/**
+ * @brief `io_registration` for each socket descriptor
+ * @note  The objects are never deleted. A late event for the unregistered
+ *        socket only sets `ready`, which leads to 1 more try of the operation.
+ */
+class io_registry final {
+    static constexpr size_t chunk_size = 1024;
+    static constexpr size_t chunk_count = 1024; // supports 1M descriptors
+    atomic<io_registration*> chunks[chunk_count]{};
+
+  public:
+    ~io_registry() noexcept {
+        for (auto& chunk : chunks)
+            delete[] chunk.load(memory_order_acquire);
+    }
+
+    /**
+     * @throw system_error `EBADF` if the descriptor is out of the range
+     */
+    io_registration& get(uint64_t sd) noexcept(false) {
+        if (sd >= chunk_size * chunk_count)
+            throw system_error{EBADF, system_category(), "io_registry"};
+        auto& chunk = chunks[sd / chunk_size];
+        auto* list = chunk.load(memory_order_acquire);
+        if (list == nullptr) {
+            auto* created = new io_registration[chunk_size]{};
+            if (chunk.compare_exchange_strong(list, created,
+                                              memory_order_acq_rel))
+                list = created;
+            else
+                delete[] created; // `list` is from the other thread
+        }
+        return list[sd % chunk_size];
+    }
+};
+
+static io_registry registry{};
+
+/**
+ * @return uint64_t inode of the open file. 0 if it's not open
+ */
+static uint64_t get_inode(uint64_t sd) noexcept {
+    struct stat info {};
+    if (fstat(static_cast<int>(sd), &info) != 0)
+        return 0;
+    return info.st_ino;
+}
+
+/**
+ * @brief Clear the state of the previous socket of the descriptor
+ */
+static void reset_registration(io_registration& reg) noexcept {
+    // the next socket starts its own sequence
+    reg.zerocopy.store(io_registration::unknown, memory_order_relaxed);
+    reg.zerocopy_sent.store(0, memory_order_relaxed);
+    reg.zerocopy_done.store(0, memory_order_relaxed);
+    reg.reader.store(0, memory_order_relaxed);
+    reg.writer.store(0, memory_order_relaxed);
+    reg.notified.store(0, memory_order_relaxed);
+}
+
+/**
+ * @brief Add the socket to the current thread's reactor if it is not
+ * @throw system_error
+ *
+ * If the registered socket was closed without `unregister_socket`, the epoll
+ * removed it with the close. Then the descriptor is registered again.
+ */
+static auto get_registration(uint64_t sd) noexcept(false) -> io_registration& {
+    auto& reg = registry.get(sd);
+    const auto inode = get_inode(sd);
+    auto state = reg.state.load(memory_order_acquire);
+    if (state == io_registration::registered &&
+        reg.inode.load(memory_order_relaxed) != inode &&
+        reg.state.compare_exchange_strong(state, io_registration::registering,
+                                          memory_order_acq_rel)) {
+        reset_registration(reg);
+        state = io_registration::unregistered;
+        reg.state.store(state, memory_order_release);
+    }
+    while (state != io_registration::registered) {
+        if (state == io_registration::registering) {
+            this_thread::yield(); // the other thread is working
+            state = reg.state.load(memory_order_acquire);
+            continue;
+        }
+        if (reg.state.compare_exchange_weak(state,
+                                            io_registration::registering,
+                                            memory_order_acq_rel) == false)
+            continue;
+        try {
+            reg.handle = static_cast<int64_t>(sd);
+            epoll_event req{};
+            req.data.ptr = addressof(reg);
+            req.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            reactor.ep.try_add(sd, req);
+            reg.owner.store(addressof(reactor.ep), memory_order_relaxed);
+            reg.inode.store(inode, memory_order_relaxed);
+        } catch (const system_error&) {
+            reg.state.store(io_registration::unregistered,
+                            memory_order_release);
+            throw;
+        }
+        reg.state.store(io_registration::registered, memory_order_release);
+        break;
+    }
+    return reg;
+}
+
+void unregister_socket(uint64_t sd) noexcept {
+    io_registration* reg = nullptr;
+    try {
+        reg = addressof(registry.get(sd));
+    } catch (const system_error&) {
+        return; // out of the range. never registered
+    }
+    auto expected = io_registration::registered;
+    if (reg->state.compare_exchange_strong(expected,
+                                           io_registration::registering,
+                                           memory_order_acq_rel) == false)
+        return;
+    try {
+        reg->owner.load(memory_order_relaxed)->remove(sd);
+    } catch (const system_error&) {
+        // the socket might be closed already. then the epoll removed it
+    }
+    reset_registration(*reg);
+    reg->state.store(io_registration::unregistered, memory_order_release);
+}
+
+void migrate_socket(uint64_t sd) noexcept(false) {
+    auto& reg = registry.get(sd);
+    auto expected = io_registration::registered;
+    if (reg.state.compare_exchange_strong(expected,
+                                          io_registration::registering,
+                                          memory_order_acq_rel) == false)
+        return; // not registered. it will be bound at the next suspension
+    auto* prev = reg.owner.load(memory_order_relaxed);
+    auto* next = addressof(reactor.ep);
+    if (prev == next) {
+        reg.state.store(io_registration::registered, memory_order_release);
+        return;
+    }
+    if (reg.reader.load(memory_order_acquire) > io_registration::ready ||
+        reg.writer.load(memory_order_acquire) > io_registration::ready ||
+        reg.notified.load(memory_order_acquire)) {
+        reg.state.store(io_registration::registered, memory_order_release);
+        throw system_error{EBUSY, system_category(),
+                           "the socket has a waiting coroutine"};
+    }
+    try {
+        prev->remove(sd);
+    } catch (const system_error&) {
+        // the reactor doesn't have it. it will be added to the next one
+    }
+    try {
+        epoll_event req{};
+        req.data.ptr = addressof(reg);
+        req.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        next->try_add(sd, req);
+    } catch (const system_error&) {
+        reg.state.store(io_registration::unregistered, memory_order_release);
+        throw;
+    }
+    reg.owner.store(next, memory_order_relaxed);
+    reg.inode.store(get_inode(sd), memory_order_relaxed);
+    reg.state.store(io_registration::registered, memory_order_release);
+}
+
+/**
+ * @brief Create a non-blocking listener with `SO_REUSEPORT`
+ * @throw system_error
+ */
+static int64_t listen_with_reuseport(const sockaddr* local, socklen_t addrlen,
+                                     int backlog) noexcept(false) {
+    const auto sd = socket(local->sa_family, SOCK_STREAM | SOCK_NONBLOCK,
+                           IPPROTO_TCP);
+    if (sd < 0)
+        throw system_error{errno, system_category(), "socket"};
+    const int on = 1;
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == 0 &&
+        bind(sd, local, addrlen) == 0 && listen(sd, backlog) == 0)
+        return sd;
+    const auto ec = errno;
+    close(sd);
+    throw system_error{ec, system_category(), "listen_reuseport"};
+}
+
+int64_t listen_reuseport(const sockaddr_in& local, //
+                         int backlog) noexcept(false) {
+    return listen_with_reuseport(reinterpret_cast<const sockaddr*>(&local),
+                                 sizeof(local), backlog);
+}
+
+int64_t listen_reuseport(const sockaddr_in6& local, //
+                         int backlog) noexcept(false) {
+    return listen_with_reuseport(reinterpret_cast<const sockaddr*>(&local),
+                                 sizeof(local), backlog);
+}
+
+/**
+ * @brief Perform the operation unless a coroutine is waiting in the slot
+ * @param perform the operation. returns like the system call
+ * @return true The operation is completed. `resume` will return the result
+ */
+static bool attempt(io_work_t& work, atomic<uintptr_t>& slot,
+                    int64_t (*perform)(io_work_t&) noexcept) noexcept {
+    auto expected = slot.load(memory_order_acquire);
+    if (expected > io_registration::ready)
+        return false;
+    // consume the event. if another one comes, the slot will be `ready`
+    if (expected == io_registration::ready)
+        slot.compare_exchange_strong(expected, 0, memory_order_acq_rel);
+    const auto sz = perform(work);
+    const auto errc = sz < 0 ? errno : 0;
+    if (errc == EAGAIN || errc == EWOULDBLOCK)
+        return false;
+    // the edge won't come again until `EAGAIN`. keep the readiness
+    expected = 0;
+    slot.compare_exchange_strong(expected, io_registration::ready,
+                                 memory_order_acq_rel);
+    complete(work, sz, errc);
+    return true;
+}
+
+/**
+ * @brief Park the waiter in the slot until the next event
+ * @param waiter coroutine address, or `io_work_t*` with `deferred` bit
+ * @return false The operation is completed with the remaining readiness
+ * @throw system_error
+ */
+static bool park(io_work_t& work, atomic<uintptr_t>& slot,
+                 int64_t (*perform)(io_work_t&) noexcept,
+                 uintptr_t waiter) noexcept(false) {
+    while (true) {
+        uintptr_t expected = 0;
+        if (slot.compare_exchange_strong(expected, waiter,
+                                         memory_order_acq_rel))
+            return true; // resumed by `poll_net_tasks`
+        if (expected != io_registration::ready)
+            throw system_error{EBUSY, system_category(),
+                               "the socket has a waiting coroutine"};
+        if (attempt(work, slot, perform))
+            return false;
+    }
+}
+
+static bool park(io_work_t& work, atomic<uintptr_t>& slot,
+                 int64_t (*perform)(io_work_t&) noexcept,
+                 coroutine_handle<void> coro) noexcept(false) {
+    return park(work, slot, perform,
+                reinterpret_cast<uintptr_t>(coro.address()));
+}
+
+/**
+ * @brief Try the operation on the non-blocking socket
+ * @param slot the direction of the operation
+ * @return true The operation is completed, or the socket is blocking
+ * @see io_work_t::ready
+ */
+static bool speculate(io_work_t& work,
+                      atomic<uintptr_t> io_registration::*slot,
+                      int64_t (*perform)(io_work_t&) noexcept) noexcept {
+    try {
+        auto& reg = registry.get(work.handle);
+        return attempt(work, reg.*slot, perform);
+    } catch (const system_error&) {
+        return false; // out of the range. `suspend` will report it
+    }
+}
+
+static void continue_zerocopy(io_work_t& work) noexcept(false);
+
+/**
+ * @brief Mark the slot `ready` and resume its waiting coroutine
+ */
+static void notify(atomic<uintptr_t>& slot) noexcept(false) {
+    const auto prev = slot.exchange(io_registration::ready, //
+                                    memory_order_acq_rel);
+    if (prev <= io_registration::ready)
+        return;
+    if (prev & io_registration::deferred)
+        return continue_zerocopy(*reinterpret_cast<io_work_t*>(
+            prev & ~io_registration::deferred));
+    coroutine_handle<void>::from_address(reinterpret_cast<void*>(prev))
+        .resume();
+}
+
+/**
+ * @brief Receive the notifications of `MSG_ZEROCOPY` in the error queue,
+ *        and resume the coroutine if all of its sends are released
+ * @return true The socket has an error other than the notifications
+ * @throw system_error
+ */
+static bool drain_notifications(io_registration& reg) noexcept(false) {
+    alignas(cmsghdr) char control[128]{};
+    while (true) {
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(reg.handle, &msg, MSG_ERRQUEUE) < 0)
+            break; // `EAGAIN`. the queue is empty
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if ((cmsg->cmsg_level != SOL_IP ||
+                 cmsg->cmsg_type != IP_RECVERR) &&
+                (cmsg->cmsg_level != SOL_IPV6 ||
+                 cmsg->cmsg_type != IPV6_RECVERR))
+                continue;
+            sock_extended_err err{};
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+            // [ee_info, ee_data] are released. they come in order
+            reg.zerocopy_done.store(err.ee_data + 1, memory_order_release);
+        }
+    }
+    if (reg.zerocopy_done.load(memory_order_acquire) ==
+        reg.zerocopy_sent.load(memory_order_acquire)) {
+        if (auto prev = reg.notified.exchange(0, memory_order_acq_rel))
+            coroutine_handle<void>::from_address(reinterpret_cast<void*>(prev))
+                .resume();
+    }
+    pollfd fd{};
+    fd.fd = static_cast<int>(reg.handle);
+    return poll(&fd, 1, 0) > 0 && (fd.revents & POLLERR);
+}
+
+/**
+ * @brief `msghdr` for `sendto`/`recvfrom`. It must live until the completion
+ */
+struct uring_msg final {
+    msghdr hdr;
+    iovec iov;
+    io_work_t* work;
+};
+
+// the low bits of `user_data`. `uring_msg*`, or `io_work_t*` for the readiness
+constexpr uint64_t uring_msg_tag = 1, uring_poll_tag = 2;
+
+/**
+ * @brief State for `io_backend::io_uring`
+ *
+ * The `user_data` of SQE is `io_work_t*`, or the others with the tags.
+ * The result of the operation is saved with `complete`.
+ * The SQEs are submitted together in `poll_net_tasks`.
+ *
+ * Each thread has its own one like `reactor`. So the coroutine is resumed
+ * in the thread which started the work, with its thread-local timer wheel.
+ */
+class uring_context final {
+  public:
+    uring_owner ring{256};
+    vector<unique_ptr<uring_msg>> msgs{}; // free list
+
+  public:
+    uring_msg* acquire_msg() noexcept(false) {
+        if (msgs.empty())
+            return new uring_msg{};
+        auto* msg = msgs.back().release();
+        msgs.pop_back();
+        return msg;
+    }
+    void release_msg(uring_msg* msg) noexcept(false) {
+        msgs.emplace_back(msg);
+    }
+};
+
+static atomic<io_backend> backend{io_backend::epoll};
+static mutex backend_mtx{}; // serialize `select_io_backend`
+static thread_local unique_ptr<uring_context> uring{};
+
+/**
+ * @brief The context of the current thread. Created at its first use
+ * @throw system_error
+ */
+static uring_context& get_uring() noexcept(false) {
+    if (uring == nullptr)
+        uring = make_unique<uring_context>();
+    return *uring;
+}
+
+bool select_io_backend(io_backend request) noexcept {
+    unique_lock lck{backend_mtx};
+    if (request == io_backend::io_uring) {
+        try {
+            get_uring(); // the other threads create their own later
+        } catch (const exception&) {
+            return false; // not supported. ENOSYS, EPERM ...
+        }
+    }
+    backend.store(request, memory_order_release);
+    return true;
+}
+
+io_backend get_io_backend() noexcept {
+    return backend.load(memory_order_acquire);
+}
+
+#if defined(USE_IO_URING)
+// fallback to epoll if the system doesn't support io_uring
+const bool uring_by_default = select_io_backend(io_backend::io_uring);
+#endif
+
+static bool use_uring() noexcept {
+    return backend.load(memory_order_relaxed) == io_backend::io_uring;
+}
+
+/**
+ * @brief Prepare a SQE for the `send`/`recv` like operation
+ * @return true always. The coroutine is resumed in `poll_net_tasks`
+ * @throw system_error
+ */
+static bool uring_submit(uint8_t opcode, io_work_t& work,
+                         coroutine_handle<void> coro) noexcept(false) {
+    work.task = coro;
+    auto* sqe = get_uring().ring.get_sqe();
+    sqe->opcode = opcode;
+    sqe->fd = static_cast<int32_t>(work.handle);
+    sqe->addr = reinterpret_cast<uint64_t>(work.buffer.data());
+    sqe->len = static_cast<uint32_t>(work.buffer.size_bytes());
+    sqe->msg_flags = get_flag(work);
+    sqe->user_data = reinterpret_cast<uint64_t>(&work);
+    return true;
+}
+
+/**
+ * @brief Prepare a SQE for the `sendto`/`recvfrom` like operation
+ * @return true always. The coroutine is resumed in `poll_net_tasks`
+ * @throw system_error
+ */
+static bool uring_submit_msg(uint8_t opcode, io_work_t& work,
+                             coroutine_handle<void> coro) noexcept(false) {
+    work.task = coro;
+    auto& ctx = get_uring();
+    auto* msg = ctx.acquire_msg();
+    msg->work = &work;
+    msg->iov.iov_base = work.buffer.data();
+    msg->iov.iov_len = work.buffer.size_bytes();
+    msg->hdr = {};
+    msg->hdr.msg_name = work.ptr;
+    msg->hdr.msg_namelen = static_cast<socklen_t>(work.internal_high);
+    msg->hdr.msg_iov = &msg->iov;
+    msg->hdr.msg_iovlen = 1;
+    try {
+        auto* sqe = ctx.ring.get_sqe();
+        sqe->opcode = opcode;
+        sqe->fd = static_cast<int32_t>(work.handle);
+        sqe->addr = reinterpret_cast<uint64_t>(&msg->hdr);
+        sqe->len = 1;
+        sqe->user_data = reinterpret_cast<uint64_t>(msg) | uring_msg_tag;
+    } catch (...) {
+        ctx.release_msg(msg);
+        throw;
+    }
+    // for `uring_cancel`. it will be overwritten with the result
+    work.internal_high = reinterpret_cast<uint64_t>(msg);
+    return true;
+}
+
+/**
+ * @brief Prepare a SQE for the `sendmsg`/`recvmsg` with the `msghdr` of user
+ * @return true always. The coroutine is resumed in `poll_net_tasks`
+ * @throw system_error
+ */
+static bool uring_submit_hdr(uint8_t opcode, io_work_t& work,
+                             coroutine_handle<void> coro) noexcept(false) {
+    work.task = coro;
+    auto* sqe = get_uring().ring.get_sqe();
+    sqe->opcode = opcode;
+    sqe->fd = static_cast<int32_t>(work.handle);
+    sqe->addr = reinterpret_cast<uint64_t>(work.ptr);
+    sqe->len = 1;
+    sqe->msg_flags = get_flag(work);
+    sqe->user_data = reinterpret_cast<uint64_t>(&work);
+    return true;
+}
+
+/**
+ * @brief Prepare a SQE to poll the socket. For the operations without opcode
+ * @param events `POLLIN` or `POLLOUT`
+ * @return true always. The coroutine is resumed in `poll_net_tasks`
+ * @throw system_error
+ *
+ * The completion is the readiness like the epoll event.
+ * Unless it is an error, `resume` performs the operation.
+ */
+static bool uring_submit_poll(io_work_t& work, uint32_t events,
+                              coroutine_handle<void> coro) noexcept(false) {
+    work.task = coro;
+    auto* sqe = get_uring().ring.get_sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = static_cast<int32_t>(work.handle);
+    sqe->poll32_events = events;
+    sqe->user_data = reinterpret_cast<uint64_t>(&work) | uring_poll_tag;
+    return true;
+}
+
+/**
+ * @brief Request cancellation of the submitted work
+ * @param user_data of the work's SQE
+ * @throw system_error
+ *
+ * The work will be completed with `ECANCELED`, or its own result
+ * if it is already done. It must be started in the current thread.
+ */
+static void uring_cancel(uint64_t user_data) noexcept(false) {
+    auto* sqe = get_uring().ring.get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = user_data;
+    sqe->user_data = 0; // not a work. ignored in `poll_uring`
+}
+
+/**
+ * @brief Submit the prepared SQEs, then resume the completed coroutines
+ *        until the completion queue is empty
+ */
+static void poll_uring(uring_context& ctx, uint64_t nano) noexcept(false) {
+    constexpr auto buf_sz = 64u;
+    io_uring_cqe buf[buf_sz]{};
+    io_work_t* works[buf_sz]{};
+
+    // returns the number of the completions in `works`
+    auto reap = [&ctx, &buf, &works]() -> size_t {
+        ctx.ring.submit();
+        size_t reaped = 0;
+        // the CQEs of `uring_cancel` are not works. don't stop with them
+        while (reaped == 0) {
+            const auto count = ctx.ring.reap(buf);
+            if (count == 0)
+                break;
+            for (auto i = 0u; i < count; ++i) {
+                auto tag = buf[i].user_data;
+                if (tag == 0) // from `uring_cancel`
+                    continue;
+                io_work_t* work = reinterpret_cast<io_work_t*>(tag);
+                if (tag & uring_msg_tag) {
+                    auto* msg =
+                        reinterpret_cast<uring_msg*>(tag & ~uring_msg_tag);
+                    work = msg->work;
+                    ctx.release_msg(msg);
+                } else if (tag & uring_poll_tag) {
+                    work = reinterpret_cast<io_work_t*>(tag & ~uring_poll_tag);
+                    if (buf[i].res < 0) // or `resume` will perform
+                        complete(*work, -1, -buf[i].res);
+                    works[reaped++] = work;
+                    continue;
+                }
+                // `IORING_OP_SEND_ZC`. the result, then the notification
+                const auto flags = buf[i].flags;
+                if ((flags & IORING_CQE_F_NOTIF) == 0) {
+                    const auto res = buf[i].res;
+                    complete(*work, res < 0 ? -1 : res, res < 0 ? -res : 0);
+                    if (flags & IORING_CQE_F_MORE)
+                        continue; // the buffer is not released yet
+                }
+                works[reaped++] = work;
+            }
+        }
+        return reaped;
+    };
+
+    auto count = reap();
+    if (count == 0) {
+        __kernel_timespec timeout{};
+        timeout.tv_sec = static_cast<int64_t>(nano / 1'000'000'000);
+        timeout.tv_nsec = static_cast<int64_t>(nano % 1'000'000'000);
+        ctx.ring.wait(&timeout);
+        count = reap();
+    }
+    while (count) {
+        for (auto i = 0u; i < count; ++i) {
+            auto task = exchange(works[i]->task, nullptr);
+            task.resume();
+        }
+        count = reap();
+    }
+}
 
 void poll_net_tasks(uint64_t nano) noexcept(false) {
-    const auto half_time = duration_cast<milliseconds>(nanoseconds{nano} / 2);
-    // event buffer for this poll
-    constexpr auto buf_sz = 30u;
-    auto buf = make_unique<epoll_event[]>(buf_sz);
-    // resume inbound coroutines
-    {
-        auto count = iep.wait(half_time.count(), {buf.get(), buf_sz});
-        for (auto i = 0u; i < count; ++i)
-            if (auto coro =
-                    coroutine_handle<void>::from_address(buf[i].data.ptr))
-                coro.resume();
+    auto& timers = get_timer_wheel();
+    auto timeout = nano > static_cast<uint64_t>(nanoseconds::max().count())
+                       ? nanoseconds::max()
+                       : nanoseconds{nano};
+    timeout = min(timeout, timers.wait_time(timer_wheel::now()));
+    if (use_uring()) {
+        poll_uring(get_uring(), static_cast<uint64_t>(timeout.count()));
+        timers.expire(timer_wheel::now());
+        return;
     }
-    // resume outbound coroutines
-    {
-        auto count = oep.wait(half_time.count(), {buf.get(), buf_sz});
-        for (auto i = 0u; i < count; ++i)
-            if (auto coro =
-                    coroutine_handle<void>::from_address(buf[i].data.ptr))
-                coro.resume();
+    constexpr size_t max_buffer_size = 4096;
+    auto& buf = reactor.events;
+    while (true) {
+        const auto count = static_cast<size_t>(reactor.ep.wait(timeout, buf));
+        for (auto i = 0u; i < count; ++i) {
+            auto* reg = static_cast<io_registration*>(buf[i].data.ptr);
+            auto events = buf[i].events;
+            // don't wake the others for the notifications of `MSG_ZEROCOPY`
+            if ((events & EPOLLERR) &&
+                reg->zerocopy.load(memory_order_relaxed) ==
+                    io_registration::zerocopy_on &&
+                drain_notifications(*reg) == false)
+                events &= ~EPOLLERR;
+            if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                notify(reg->reader);
+            if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+                notify(reg->writer);
+        }
+        if (count == 0)
+            break;
+        if (count == buf.size() && buf.size() < max_buffer_size)
+            buf.resize(buf.size() * 2);
+        // drain the events until nothing is ready
+        timeout = nanoseconds::zero();
     }
+    timers.expire(timer_wheel::now());
 }
 
 bool io_work_t::ready() const noexcept {
     auto sd = this->handle;
+    // not cached. the descriptor can be reused by another socket without
+    // `unregister_socket`, or switched with `fcntl` after the first await
     // non blocking operation is expected going to suspend
     if (fcntl(sd, F_GETFL, 0) & O_NONBLOCK)
         return false;
@@ -50,10 +743,80 @@ uint32_t io_work_t::error() const noexcept {
     return gsl::narrow_cast<uint32_t>(this->internal);
 }
 
+static int64_t perform_send_to(io_work_t& work) noexcept {
+    auto addr = reinterpret_cast<sockaddr*>(work.ptr);
+    auto addrlen = static_cast<socklen_t>(work.internal_high);
+    return sendto(work.handle, work.buffer.data(), work.buffer.size_bytes(),
+                  0, addr, addrlen);
+}
+
+static int64_t perform_recv_from(io_work_t& work) noexcept {
+    auto addr = reinterpret_cast<sockaddr*>(work.ptr);
+    auto addrlen = static_cast<socklen_t>(work.internal_high);
+    return recvfrom(work.handle, work.buffer.data(),
+                    work.buffer.size_bytes(), 0, addr, addressof(addrlen));
+}
+
+static int64_t perform_send(io_work_t& work) noexcept {
+    return send(work.handle, work.buffer.data(), work.buffer.size_bytes(),
+                get_flag(work));
+}
+
+static int64_t perform_recv(io_work_t& work) noexcept {
+    return recv(work.handle, work.buffer.data(), work.buffer.size_bytes(),
+                get_flag(work));
+}
+
+static int64_t perform_send_msg(io_work_t& work) noexcept {
+    return sendmsg(work.handle, static_cast<const msghdr*>(work.ptr),
+                   get_flag(work));
+}
+
+static int64_t perform_recv_msg(io_work_t& work) noexcept {
+    return recvmsg(work.handle, static_cast<msghdr*>(work.ptr),
+                   get_flag(work));
+}
+
+// `io_work_t::buffer` is the bytes of `mmsghdr` array for the batch
+static auto get_batch(io_work_t& work) noexcept -> gsl::span<mmsghdr> {
+    const auto count = work.buffer.size_bytes() / sizeof(mmsghdr);
+    return gsl::span<mmsghdr>(reinterpret_cast<mmsghdr*>(work.buffer.data()),
+                              gsl::narrow_cast<ptrdiff_t>(count));
+}
+
+static int64_t perform_send_batch(io_work_t& work) noexcept {
+    auto msgs = get_batch(work);
+    return sendmmsg(work.handle, msgs.data(),
+                    static_cast<uint32_t>(msgs.size()), get_flag(work));
+}
+
+static int64_t perform_recv_batch(io_work_t& work) noexcept {
+    auto msgs = get_batch(work);
+    // don't wait for the whole slots. the blocking socket too
+    return recvmmsg(work.handle, msgs.data(),
+                    static_cast<uint32_t>(msgs.size()),
+                    get_flag(work) | MSG_WAITFORONE, nullptr);
+}
+
+/**
+ * @brief Return the saved result, or perform the operation now
+ */
+static int64_t resume_work(io_work_t& work,
+                           int64_t (*perform)(io_work_t&) noexcept) noexcept {
+    int64_t sz = 0;
+    if (take_completion(work, sz))
+        return sz;
+    sz = perform(work);
+    // update error code upon i/o failure
+    set_error(work, sz < 0 ? errno : 0);
+    return sz;
+}
+
 auto send_to(uint64_t sd, const sockaddr_in& remote, io_buffer_t buffer,
              io_work_t& work) noexcept(false) -> io_send_to& {
     work.handle = sd;
     work.ptr = const_cast<sockaddr_in*>(addressof(remote));
+    work.internal = 0;
     work.internal_high = sizeof(sockaddr_in);
     work.buffer = buffer;
     return *reinterpret_cast<io_send_to*>(addressof(work));
@@ -63,39 +826,36 @@ auto send_to(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buffer,
              io_work_t& work) noexcept(false) -> io_send_to& {
     work.handle = sd;
     work.ptr = const_cast<sockaddr_in6*>(addressof(remote));
+    work.internal = 0;
     work.internal_high = sizeof(sockaddr_in6);
     work.buffer = buffer;
     return *reinterpret_cast<io_send_to*>(addressof(work));
 }
 
-void io_send_to::suspend(coroutine_handle<void> coro) noexcept(false) {
-    auto sd = this->handle;
-    auto& errc = this->internal;
-    errc = 0;
-
-    epoll_event req{};
-    req.events = EPOLLOUT | EPOLLONESHOT | EPOLLET;
-    req.data.ptr = coro.address();
+bool io_send_to::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_send_to);
+}
 
-    oep.try_add(sd, req); // throws if epoll_ctl fails
+bool io_send_to::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_msg(IORING_OP_SENDMSG, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_send_to, coro);
 }
 
 int64_t io_send_to::resume() noexcept {
-    auto sd = this->handle;
-    auto addr = reinterpret_cast<sockaddr*>(this->ptr);
-    auto addrlen = static_cast<socklen_t>(this->internal_high);
-    auto& errc = this->internal;
-    auto sz = sendto(sd, buffer.data(), buffer.size_bytes(), //
-                     0, addr, addrlen);
-    // update error code upon i/o failure
-    errc = sz < 0 ? errno : 0;
-    return sz;
+    return resume_work(*this, perform_send_to);
 }
 
 auto recv_from(uint64_t sd, sockaddr_in& remote, io_buffer_t buffer,
                io_work_t& work) noexcept(false) -> io_recv_from& {
     work.handle = sd;
     work.ptr = addressof(remote);
+    work.internal = 0;
     work.internal_high = sizeof(sockaddr_in);
     work.buffer = buffer;
     return *reinterpret_cast<io_recv_from*>(addressof(work));
@@ -105,95 +865,1142 @@ auto recv_from(uint64_t sd, sockaddr_in6& remote, io_buffer_t buffer,
                io_work_t& work) noexcept(false) -> io_recv_from& {
     work.handle = sd;
     work.ptr = addressof(remote);
+    work.internal = 0;
     work.internal_high = sizeof(sockaddr_in6);
     work.buffer = buffer;
     return *reinterpret_cast<io_recv_from*>(addressof(work));
 }
 
-void io_recv_from::suspend(coroutine_handle<void> coro) noexcept(false) {
-    auto sd = this->handle;
-    auto& errc = this->internal;
-    errc = 0;
-
-    epoll_event req{};
-    req.events = EPOLLIN | EPOLLONESHOT | EPOLLET;
-    req.data.ptr = coro.address();
+bool io_recv_from::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_recv_from);
+}
 
-    iep.try_add(sd, req); // throws if epoll_ctl fails
+bool io_recv_from::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_msg(IORING_OP_RECVMSG, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_recv_from, coro);
 }
 
 int64_t io_recv_from::resume() noexcept {
-    auto sd = this->handle;
-    auto addr = reinterpret_cast<sockaddr*>(this->ptr);
-    auto addrlen = static_cast<socklen_t>(this->internal_high);
-    auto& errc = this->internal;
-    auto sz = recvfrom(sd, buffer.data(), buffer.size_bytes(), //
-                       0, addr, addressof(addrlen));
-    // update error code upon i/o failure
-    errc = sz < 0 ? errno : 0;
-    return sz;
+    return resume_work(*this, perform_recv_from);
 }
 
 auto send_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
                  io_work_t& work) noexcept(false) -> io_send& {
     static_assert(sizeof(socklen_t) == sizeof(uint32_t));
     work.handle = sd;
-    work.internal = flag;
+    work.internal = static_cast<uint64_t>(flag) << 32;
     work.buffer = buffer;
     return *reinterpret_cast<io_send*>(addressof(work));
 }
 
-void io_send::suspend(coroutine_handle<void> coro) noexcept(false) {
-    auto sd = this->handle;
-    auto& errc = this->internal;
-    errc = 0;
-
-    epoll_event req{};
-    req.events = EPOLLOUT | EPOLLONESHOT | EPOLLET;
-    req.data.ptr = coro.address();
+bool io_send::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_send);
+}
 
-    oep.try_add(sd, req); // throws if epoll_ctl fails
+bool io_send::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit(IORING_OP_SEND, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_send, coro);
 }
 
 int64_t io_send::resume() noexcept {
-    auto sd = this->handle;
-    auto flag = this->internal;
-    auto& errc = this->internal;
-    const auto sz = send(sd, buffer.data(), buffer.size_bytes(), flag);
-    // update error code upon i/o failure
-    errc = sz < 0 ? errno : 0;
-    return sz;
+    return resume_work(*this, perform_send);
 }
 
 auto recv_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
                  io_work_t& work) noexcept(false) -> io_recv& {
     static_assert(sizeof(socklen_t) == sizeof(uint32_t));
     work.handle = sd;
-    work.internal = flag;
+    work.internal = static_cast<uint64_t>(flag) << 32;
     work.buffer = buffer;
     return *reinterpret_cast<io_recv*>(addressof(work));
 }
 
-void io_recv::suspend(coroutine_handle<void> coro) noexcept(false) {
-    auto sd = this->handle;
-    auto& errc = this->internal;
-    errc = 0;
-
-    epoll_event req{};
-    req.events = EPOLLIN | EPOLLONESHOT | EPOLLET;
-    req.data.ptr = coro.address();
+bool io_recv::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_recv);
+}
 
-    iep.try_add(sd, req);
+bool io_recv::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit(IORING_OP_RECV, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_recv, coro);
 }
 
 int64_t io_recv::resume() noexcept {
-    auto sd = this->handle;
-    auto flag = this->internal;
-    auto& errc = this->internal;
-    const auto sz = recv(sd, buffer.data(), buffer.size_bytes(), flag);
-    // update error code upon i/o failure
-    errc = sz < 0 ? errno : 0;
+    return resume_work(*this, perform_recv);
+}
+
+auto send_msg(uint64_t sd, const msghdr& msg, uint32_t flag,
+              io_work_t& work) noexcept(false) -> io_send_msg& {
+    work.handle = sd;
+    work.ptr = const_cast<msghdr*>(addressof(msg));
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.buffer = {};
+    return *reinterpret_cast<io_send_msg*>(addressof(work));
+}
+
+bool io_send_msg::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_send_msg);
+}
+
+bool io_send_msg::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_hdr(IORING_OP_SENDMSG, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_send_msg, coro);
+}
+
+int64_t io_send_msg::resume() noexcept {
+    return resume_work(*this, perform_send_msg);
+}
+
+auto recv_msg(uint64_t sd, msghdr& msg, uint32_t flag,
+              io_work_t& work) noexcept(false) -> io_recv_msg& {
+    work.handle = sd;
+    work.ptr = addressof(msg);
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.buffer = {};
+    return *reinterpret_cast<io_recv_msg*>(addressof(work));
+}
+
+bool io_recv_msg::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_recv_msg);
+}
+
+bool io_recv_msg::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_hdr(IORING_OP_RECVMSG, *this, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_recv_msg, coro);
+}
+
+int64_t io_recv_msg::resume() noexcept {
+    return resume_work(*this, perform_recv_msg);
+}
+
+auto send_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_send_batch& {
+    work.handle = sd;
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.buffer = gsl::as_writeable_bytes(msgs);
+    return *reinterpret_cast<io_send_batch*>(addressof(work));
+}
+
+bool io_send_batch::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_send_batch);
+}
+
+bool io_send_batch::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_poll(*this, POLLOUT, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_send_batch, coro);
+}
+
+int64_t io_send_batch::resume() noexcept {
+    return resume_work(*this, perform_send_batch);
+}
+
+auto recv_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_recv_batch& {
+    work.handle = sd;
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.buffer = gsl::as_writeable_bytes(msgs);
+    return *reinterpret_cast<io_recv_batch*>(addressof(work));
+}
+
+bool io_recv_batch::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_recv_batch);
+}
+
+bool io_recv_batch::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_poll(*this, POLLIN, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_recv_batch, coro);
+}
+
+int64_t io_recv_batch::resume() noexcept {
+    return resume_work(*this, perform_recv_batch);
+}
+
+void set_udp_gro(uint64_t sd, bool enable) noexcept(false) {
+    int opt = enable;
+    if (setsockopt(sd, SOL_UDP, UDP_GRO, &opt, sizeof(opt)))
+        throw system_error{errno, system_category(), "setsockopt(UDP_GRO)"};
+}
+
+/**
+ * @brief Prepare the `msghdr` for 1 buffer and the remote address
+ */
+static void prepare_segments(io_segment_msg& msg, const void* remote,
+                             socklen_t addrlen, io_buffer_t buffer) noexcept {
+    msg.iov.iov_base = buffer.data();
+    msg.iov.iov_len = static_cast<size_t>(buffer.size_bytes());
+    msg.hdr = {};
+    msg.hdr.msg_name = const_cast<void*>(remote);
+    msg.hdr.msg_namelen = addrlen;
+    msg.hdr.msg_iov = &msg.iov;
+    msg.hdr.msg_iovlen = 1;
+    msg.hdr.msg_control = msg.control;
+}
+
+/**
+ * @brief Put `UDP_SEGMENT` in the control buffer
+ */
+static auto set_segment_size(io_segment_msg& msg, uint16_t segment) noexcept
+    -> const msghdr& {
+    msg.hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+    auto* cmsg = CMSG_FIRSTHDR(&msg.hdr);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    memcpy(CMSG_DATA(cmsg), &segment, sizeof(uint16_t));
+    return msg.hdr;
+}
+
+auto send_segments(uint64_t sd, const sockaddr_in& remote, io_buffer_t buffer,
+                   uint16_t segment, io_segment_msg& msg,
+                   io_work_t& work) noexcept(false) -> io_send_msg& {
+    prepare_segments(msg, &remote, sizeof(sockaddr_in), buffer);
+    return send_msg(sd, set_segment_size(msg, segment), 0, work);
+}
+
+auto send_segments(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buffer,
+                   uint16_t segment, io_segment_msg& msg,
+                   io_work_t& work) noexcept(false) -> io_send_msg& {
+    prepare_segments(msg, &remote, sizeof(sockaddr_in6), buffer);
+    return send_msg(sd, set_segment_size(msg, segment), 0, work);
+}
+
+auto recv_segments(uint64_t sd, sockaddr_in& remote, io_buffer_t buffer,
+                   io_segment_msg& msg, io_work_t& work) noexcept(false)
+    -> io_recv_msg& {
+    prepare_segments(msg, &remote, sizeof(sockaddr_in), buffer);
+    msg.hdr.msg_controllen = sizeof(msg.control);
+    return recv_msg(sd, msg.hdr, 0, work);
+}
+
+auto recv_segments(uint64_t sd, sockaddr_in6& remote, io_buffer_t buffer,
+                   io_segment_msg& msg, io_work_t& work) noexcept(false)
+    -> io_recv_msg& {
+    prepare_segments(msg, &remote, sizeof(sockaddr_in6), buffer);
+    msg.hdr.msg_controllen = sizeof(msg.control);
+    return recv_msg(sd, msg.hdr, 0, work);
+}
+
+uint16_t get_segment_size(const io_segment_msg& msg) noexcept {
+    auto& hdr = const_cast<msghdr&>(msg.hdr);
+    for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+         cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO)
+            continue;
+        int segment = 0;
+        memcpy(&segment, CMSG_DATA(cmsg), sizeof(int));
+        return static_cast<uint16_t>(segment);
+    }
+    return 0;
+}
+
+// smaller ones are copied. the notification costs more than the copy
+constexpr size_t zerocopy_threshold = 16 * 1024;
+// `io_work_t::offset_high` of `io_send_zerocopy`
+constexpr int32_t zerocopy_none = 0, zerocopy_sent = 1;
+
+/**
+ * @return true Send with `MSG_ZEROCOPY`. `SO_ZEROCOPY` is enabled at the first
+ */
+static bool use_zerocopy(io_work_t& work, io_registration& reg) noexcept {
+    if (static_cast<size_t>(work.buffer.size_bytes()) < zerocopy_threshold)
+        return false;
+    auto state = reg.zerocopy.load(memory_order_relaxed);
+    if (state == io_registration::unknown) {
+        const int on = 1;
+        state = setsockopt(work.handle, SOL_SOCKET, SO_ZEROCOPY, //
+                           &on, sizeof(on))
+                    ? io_registration::zerocopy_off
+                    : io_registration::zerocopy_on;
+        reg.zerocopy.store(state, memory_order_relaxed);
+    }
+    return state == io_registration::zerocopy_on;
+}
+
+static int64_t perform_send_zerocopy(io_work_t& work) noexcept {
+    const auto sz = send(work.handle, work.buffer.data(),
+                         work.buffer.size_bytes(),
+                         get_flag(work) | MSG_ZEROCOPY);
+    if (sz >= 0)
+        work.offset_high = zerocopy_sent;
+    else if (errno == ENOBUFS) // out of the option memory. copy this one
+        return perform_send(work);
+    return sz;
+}
+
+/**
+ * @brief Park the coroutine until the notification of its send
+ * @return false The buffer is copied, or released already
+ * @throw system_error
+ */
+static bool wait_notification(io_work_t& work,
+                              io_registration& reg) noexcept(false) {
+    if (work.offset_high != zerocopy_sent)
+        return false;
+    work.offset_high = zerocopy_none;
+    reg.zerocopy_sent.fetch_add(1, memory_order_acq_rel);
+    const auto waiter = reinterpret_cast<uintptr_t>(work.task.address());
+    uintptr_t expected = 0;
+    if (reg.notified.compare_exchange_strong(expected, waiter,
+                                             memory_order_acq_rel) == false)
+        throw system_error{EBUSY, system_category(),
+                           "the socket has a waiting coroutine"};
+    if (reg.zerocopy_done.load(memory_order_acquire) !=
+        reg.zerocopy_sent.load(memory_order_acquire))
+        return true;
+    // released already. take it back unless `drain_notifications` did
+    expected = waiter;
+    return reg.notified.compare_exchange_strong(expected, 0,
+                                                memory_order_acq_rel) == false;
+}
+
+/**
+ * @brief The socket is writable. Send, then wait for the notification
+ * @see notify
+ */
+static void continue_zerocopy(io_work_t& work) noexcept(false) {
+    auto& reg = registry.get(work.handle);
+    const auto waiter =
+        reinterpret_cast<uintptr_t>(&work) | io_registration::deferred;
+    if (park(work, reg.writer, perform_send_zerocopy, waiter))
+        return; // `EAGAIN`. wait for the next event
+    if (wait_notification(work, reg) == false)
+        work.task.resume();
+}
+
+auto send_zerocopy(uint64_t sd, io_buffer_t buffer, uint32_t flag,
+                   io_work_t& work) noexcept(false) -> io_send_zerocopy& {
+    work.handle = sd;
+    work.ptr = nullptr; // `zerocopy_none`
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.buffer = buffer;
+    return *reinterpret_cast<io_send_zerocopy*>(addressof(work));
+}
+
+bool io_send_zerocopy::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true; // copy in `resume`
+    try {
+        auto& reg = registry.get(this->handle);
+        if (use_zerocopy(*this, reg) == false)
+            return attempt(*this, reg.writer, perform_send);
+        // `IORING_OP_SEND_ZC`, or `EBUSY` in `suspend`
+        if (use_uring() || reg.notified.load(memory_order_acquire))
+            return false;
+        // the buffer is in use until the notification
+        return attempt(*this, reg.writer, perform_send_zerocopy) &&
+               this->offset_high != zerocopy_sent;
+    } catch (const system_error&) {
+        return false; // out of the range. `suspend` will report it
+    }
+}
+
+bool io_send_zerocopy::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    this->task = coro;
+    if (use_uring()) {
+        if (use_zerocopy(*this, registry.get(this->handle)) == false)
+            return uring_submit(IORING_OP_SEND, *this, coro);
+        this->offset_high = zerocopy_sent;
+        return uring_submit(IORING_OP_SEND_ZC, *this, coro);
+    }
+    auto& reg = get_registration(this->handle);
+    if (this->offset_high == zerocopy_sent) // sent in `ready`
+        return wait_notification(*this, reg);
+    if (use_zerocopy(*this, reg) == false)
+        return park(*this, reg.writer, perform_send, coro);
+    if (reg.notified.load(memory_order_acquire))
+        throw system_error{EBUSY, system_category(),
+                           "the socket has a waiting coroutine"};
+    // the reactor will send and wait for the notification
+    const auto waiter =
+        reinterpret_cast<uintptr_t>(this) | io_registration::deferred;
+    if (park(*this, reg.writer, perform_send_zerocopy, waiter))
+        return true;
+    return wait_notification(*this, reg);
+}
+
+int64_t io_send_zerocopy::resume() noexcept {
+    const bool zerocopy = exchange(this->offset_high, zerocopy_none) ==
+                          zerocopy_sent;
+    int64_t sz = 0;
+    if (take_completion(*this, sz) == false)
+        return resume_work(*this, perform_send);
+    if (zerocopy && sz < 0 && this->error() == EINVAL) {
+        // `IORING_OP_SEND_ZC` requires Linux 6.0. copy from now on
+        try {
+            registry.get(this->handle)
+                .zerocopy.store(io_registration::zerocopy_off,
+                                memory_order_relaxed);
+        } catch (const system_error&) {
+        }
+        return resume_work(*this, perform_send);
+    }
     return sz;
 }
 
+// `io_work_t::buffer` is the bytes of the sockets for `accept`
+static auto get_sockets(io_work_t& work) noexcept -> gsl::span<int64_t> {
+    const auto count = work.buffer.size_bytes() / sizeof(int64_t);
+    return gsl::span<int64_t>(reinterpret_cast<int64_t*>(work.buffer.data()),
+                              gsl::narrow_cast<ptrdiff_t>(count));
+}
+
+static int64_t perform_accept(io_work_t& work) noexcept {
+    constexpr auto flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    if (work.buffer.empty())
+        return accept4(work.handle, nullptr, nullptr, flags);
+    int64_t count = 0;
+    for (auto& sd : get_sockets(work)) { // drain the backlog
+        sd = accept4(work.handle, nullptr, nullptr, flags);
+        if (sd < 0)
+            break;
+        ++count;
+    }
+    return count ? count : -1;
+}
+
+// the flag of `io_connect`. `connect` returned `EINPROGRESS`
+constexpr uint64_t connect_in_progress = uint64_t{1} << 32;
+
+static int64_t perform_connect(io_work_t& work) noexcept {
+    const auto addr = reinterpret_cast<const sockaddr*>(work.ptr);
+    const auto addrlen = static_cast<socklen_t>(work.internal_high);
+    if ((work.internal & connect_in_progress) == 0) {
+        if (connect(work.handle, addr, addrlen) == 0)
+            return 0;
+        if (errno != EINPROGRESS)
+            return -1;
+        work.internal |= connect_in_progress;
+        errno = EAGAIN; // wait for `EPOLLOUT`
+        return -1;
+    }
+    int errc = 0;
+    socklen_t len = sizeof(errc);
+    if (getsockopt(work.handle, SOL_SOCKET, SO_ERROR, &errc, &len))
+        return -1;
+    if (errc) {
+        errno = errc;
+        return -1;
+    }
+    // no error yet. `EALREADY` if the handshake is not finished
+    if (connect(work.handle, addr, addrlen) == 0 || errno == EISCONN)
+        return 0;
+    if (errno == EALREADY)
+        errno = EAGAIN;
+    return -1;
+}
+
+auto accept(uint64_t ln, io_work_t& work) noexcept(false) -> io_accept& {
+    work.handle = ln;
+    work.internal = 0;
+    work.buffer = {};
+    return *reinterpret_cast<io_accept*>(addressof(work));
+}
+
+auto accept(uint64_t ln, gsl::span<int64_t> sockets,
+            io_work_t& work) noexcept(false) -> io_accept& {
+    work.handle = ln;
+    work.internal = 0;
+    work.buffer = gsl::as_writeable_bytes(sockets);
+    return *reinterpret_cast<io_accept*>(addressof(work));
+}
+
+bool io_accept::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_accept);
+}
+
+bool io_accept::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring()) // `accept4` in `resume` for the backlog
+        return uring_submit_poll(*this, POLLIN, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_accept, coro);
+}
+
+int64_t io_accept::resume() noexcept {
+    return resume_work(*this, perform_accept);
+}
+
+auto connect(uint64_t sd, const sockaddr_in& remote,
+             io_work_t& work) noexcept(false) -> io_connect& {
+    work.handle = sd;
+    work.ptr = const_cast<sockaddr_in*>(addressof(remote));
+    work.internal = 0;
+    work.internal_high = sizeof(sockaddr_in);
+    return *reinterpret_cast<io_connect*>(addressof(work));
+}
+
+auto connect(uint64_t sd, const sockaddr_in6& remote,
+             io_work_t& work) noexcept(false) -> io_connect& {
+    work.handle = sd;
+    work.ptr = const_cast<sockaddr_in6*>(addressof(remote));
+    work.internal = 0;
+    work.internal_high = sizeof(sockaddr_in6);
+    return *reinterpret_cast<io_connect*>(addressof(work));
+}
+
+bool io_connect::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    // `connect` starts here. usually it returns `EINPROGRESS`
+    return speculate(*this, &io_registration::writer, perform_connect);
+}
+
+bool io_connect::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring())
+        return uring_submit_poll(*this, POLLOUT, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_connect, coro);
+}
+
+int64_t io_connect::resume() noexcept {
+    return resume_work(*this, perform_connect);
+}
+
+//
+//  `send_file`/`splice_file` keep the file in the flag of `internal`,
+//  `int64_t*` offset in `ptr`, and the count in `internal_high`
+//
+static_assert(sizeof(off_t) == sizeof(int64_t));
+
+static int64_t perform_send_file(io_work_t& work) noexcept {
+    return sendfile(work.handle, static_cast<int>(get_flag(work)),
+                    static_cast<off_t*>(work.ptr),
+                    static_cast<size_t>(work.internal_high));
+}
+
+// `io_work_t::buffer` is the bytes of `io_pipe` for the splice
+static auto get_pipe(io_work_t& work) noexcept -> io_pipe& {
+    return *reinterpret_cast<io_pipe*>(work.buffer.data());
+}
+
+static int64_t perform_splice_file(io_work_t& work) noexcept {
+    constexpr auto flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+    auto& pipe = get_pipe(work);
+    if (pipe.pending == 0) {
+        // from the file. it doesn't wait
+        const auto sz = splice(static_cast<int>(get_flag(work)),
+                               static_cast<loff_t*>(work.ptr), pipe.writer,
+                               nullptr, work.internal_high, flags);
+        if (sz <= 0) // the end of the file, or error
+            return sz;
+        pipe.pending = static_cast<size_t>(sz);
+    }
+    const auto sz = splice(pipe.reader, nullptr, work.handle, nullptr,
+                           pipe.pending, flags);
+    if (sz > 0)
+        pipe.pending -= static_cast<size_t>(sz);
+    return sz;
+}
+
+auto send_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+               io_work_t& work) noexcept(false) -> io_send_file& {
+    work.handle = sd;
+    work.ptr = addressof(offset);
+    work.internal = static_cast<uint64_t>(fd) << 32;
+    work.internal_high = count;
+    return *reinterpret_cast<io_send_file*>(addressof(work));
+}
+
+bool io_send_file::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_send_file);
+}
+
+bool io_send_file::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring()) // no opcode for `sendfile`
+        return uring_submit_poll(*this, POLLOUT, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_send_file, coro);
+}
+
+int64_t io_send_file::resume() noexcept {
+    return resume_work(*this, perform_send_file);
+}
+
+io_pipe::io_pipe() noexcept(false) {
+    int fds[2]{};
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC))
+        throw system_error{errno, system_category(), "pipe2"};
+    reader = fds[0];
+    writer = fds[1];
+}
+
+io_pipe::~io_pipe() noexcept {
+    close(reader);
+    close(writer);
+}
+
+auto splice_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+                 io_pipe& pipe, io_work_t& work) noexcept(false)
+    -> io_splice_file& {
+    work.handle = sd;
+    work.ptr = addressof(offset);
+    work.internal = static_cast<uint64_t>(fd) << 32;
+    work.internal_high = count;
+    work.buffer = {reinterpret_cast<std::byte*>(addressof(pipe)),
+                   sizeof(io_pipe)};
+    return *reinterpret_cast<io_splice_file*>(addressof(work));
+}
+
+bool io_splice_file::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::writer, perform_splice_file);
+}
+
+bool io_splice_file::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring()) // 2 splices for 1 operation. wait for the socket
+        return uring_submit_poll(*this, POLLOUT, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.writer, perform_splice_file, coro);
+}
+
+int64_t io_splice_file::resume() noexcept {
+    return resume_work(*this, perform_splice_file);
+}
+
+//
+//  Each buffer of `io_buffer_pool` has the index of its class in front.
+//  The free buffers are linked through their first bytes
+//
+constexpr size_t pool_header_size = alignof(max_align_t);
+
+static size_t get_class(size_t size) noexcept {
+    size_t index = 0;
+    while ((io_buffer_pool::min_size << index) < size)
+        ++index;
+    return index;
+}
+
+static auto get_header(std::byte* data) noexcept -> size_t* {
+    return reinterpret_cast<size_t*>(data - pool_header_size);
+}
+
+io_buffer_pool::io_buffer_pool(size_t retain) noexcept : retain{retain} {
+}
+
+io_buffer_pool::~io_buffer_pool() noexcept {
+    for (auto head : heads)
+        while (head) {
+            auto next = *static_cast<void**>(head);
+            ::operator delete(get_header(static_cast<std::byte*>(head)));
+            head = next;
+        }
+}
+
+auto io_buffer_pool::acquire(size_t size) noexcept(false) -> io_buffer_t {
+    if (size > max_size)
+        throw system_error{EINVAL, system_category(),
+                           "the size is over io_buffer_pool::max_size"};
+    const auto index = get_class(size);
+    const auto length = min_size << index;
+    std::byte* data = nullptr;
+    {
+        unique_lock lck{mtx};
+        if (auto head = heads[index]) {
+            heads[index] = *static_cast<void**>(head);
+            cached[index] -= length;
+            data = static_cast<std::byte*>(head);
+        }
+        ++count;
+    }
+    if (data == nullptr) {
+        try {
+            auto block = static_cast<std::byte*>(
+                ::operator new(pool_header_size + length));
+            data = block + pool_header_size;
+        } catch (...) {
+            unique_lock lck{mtx};
+            --count;
+            throw;
+        }
+        *get_header(data) = index;
+    }
+    return io_buffer_t(data, gsl::narrow_cast<ptrdiff_t>(length));
+}
+
+void io_buffer_pool::release(io_buffer_t buffer) noexcept {
+    const auto data = buffer.data();
+    const auto index = *get_header(data);
+    const auto length = min_size << index;
+    {
+        unique_lock lck{mtx};
+        --count;
+        if (cached[index] + length <= retain) {
+            *reinterpret_cast<void**>(data) = heads[index];
+            heads[index] = data;
+            cached[index] += length;
+            return;
+        }
+    }
+    ::operator delete(get_header(data));
+}
+
+size_t io_buffer_pool::leased() noexcept {
+    unique_lock lck{mtx};
+    return count;
+}
+
+//
+//  `recv_lease` keeps `io_lease*` in `ptr` and the size in `internal_high`.
+//  `internal_high` is overwritten by `complete` after the `perform`
+//
+static int64_t perform_recv_lease(io_work_t& work) noexcept {
+    auto& lease = *static_cast<io_lease*>(work.ptr);
+    io_buffer_t buf{};
+    try {
+        buf = lease.pool.acquire(work.internal_high);
+    } catch (const system_error& e) {
+        errno = e.code().value();
+        return -1;
+    } catch (const bad_alloc&) {
+        errno = ENOMEM;
+        return -1;
+    }
+    const auto sz = recv(work.handle, buf.data(), buf.size_bytes(),
+                         get_flag(work));
+    if (sz > 0) {
+        lease.buffer = buf.first(sz);
+        return sz;
+    }
+    const auto errc = errno;
+    lease.pool.release(buf); // EAGAIN, EOF, or the error
+    errno = errc;
+    return sz;
+}
+
+auto recv_lease(uint64_t sd, io_lease& lease, size_t size, uint32_t flag,
+                io_work_t& work) noexcept(false) -> io_recv_lease& {
+    lease.release();
+    work.handle = sd;
+    work.ptr = addressof(lease);
+    work.internal = static_cast<uint64_t>(flag) << 32;
+    work.internal_high = size;
+    work.buffer = {};
+    return *reinterpret_cast<io_recv_lease*>(addressof(work));
+}
+
+bool io_recv_lease::ready() noexcept {
+    set_error(*this, 0);
+    if (io_work_t::ready())
+        return true;
+    return speculate(*this, &io_registration::reader, perform_recv_lease);
+}
+
+bool io_recv_lease::suspend(coroutine_handle<void> coro) noexcept(false) {
+    set_error(*this, 0);
+    if (use_uring()) // nothing is leased until `POLLIN`
+        return uring_submit_poll(*this, POLLIN, coro);
+    auto& reg = get_registration(this->handle);
+    return park(*this, reg.reader, perform_recv_lease, coro);
+}
+
+int64_t io_recv_lease::resume() noexcept {
+    return resume_work(*this, perform_recv_lease);
+}
+
+io_cancel_token::~io_cancel_token() noexcept {
+    // the works are not aborted. they will continue without this token
+    while (head) {
+        auto* work = head;
+        work->unlink();
+        work->token = nullptr;
+    }
+}
+
+void io_cancel_token::cancel() noexcept(false) {
+    requested = true;
+    // the resumed coroutines may destroy this token, or start the new works.
+    // abort the detached list. this is not used after that
+    io_cancel_token detached{};
+    detached.head = exchange(head, nullptr);
+    for (auto* work = detached.head; work; work = work->token_next)
+        work->token = &detached;
+    while (detached.head) // `abort` removes the work from the list
+        detached.head->abort(ECANCELED);
+}
+
+io_deadline::io_deadline(io_work_t& _work, operation _op,
+                         steady_clock::time_point _until,
+                         io_cancel_token* _token) noexcept
+    : io_timer{}, work{_work}, op{_op}, until{_until}, token{_token} {
+}
+
+io_deadline::~io_deadline() noexcept {
+    unlink();
+}
+
+void io_deadline::link(io_cancel_token& source) noexcept {
+    token_prev = nullptr;
+    token_next = source.head;
+    if (source.head)
+        source.head->token_prev = this;
+    source.head = this;
+}
+
+void io_deadline::unlink() noexcept {
+    if (token == nullptr)
+        return;
+    if (token_prev)
+        token_prev->token_next = token_next;
+    else if (token->head == this)
+        token->head = token_next;
+    if (token_next)
+        token_next->token_prev = token_prev;
+    token_next = token_prev = nullptr;
+}
+
+void io_deadline::abort(uint32_t errc) noexcept(false) {
+    io_timer::cancel();
+    unlink();
+    token = nullptr; // already unlinked
+    reason = errc;
+    const bool inbound = op == operation::recv ||
+                         op == operation::recv_from ||
+                         op == operation::recv_msg ||
+                         op == operation::recv_batch ||
+                         op == operation::accept;
+    if (use_uring()) { // `poll_net_tasks` will resume with `ECANCELED`
+        auto user_data = reinterpret_cast<uint64_t>(&work);
+        if (op == operation::send_to || op == operation::recv_from)
+            user_data = work.internal_high | uring_msg_tag;
+        else if (op == operation::send_batch ||
+                 op == operation::recv_batch ||
+                 op == operation::send_file ||
+                 op == operation::splice_file || op == operation::accept ||
+                 op == operation::connect)
+            user_data |= uring_poll_tag;
+        return uring_cancel(user_data);
+    }
+
+    auto& reg = registry.get(work.handle);
+    auto& slot = inbound ? reg.reader : reg.writer;
+    auto waiter = reinterpret_cast<uintptr_t>(work.task.address());
+    // if failed, the event came first and the coroutine is being resumed
+    if (slot.compare_exchange_strong(waiter, 0, memory_order_acq_rel) == false)
+        return;
+    complete(work, -1, errc);
+    work.task.resume();
+}
+
+void io_deadline::on_deadline(io_timer& timer) noexcept(false) {
+    static_cast<io_deadline&>(timer).abort(ETIMEDOUT);
+}
+
+bool io_deadline::await_ready() noexcept {
+    reason = 0;
+    if (token && token->requested) {
+        complete(work, -1, ECANCELED);
+        return true;
+    }
+    if (until <= steady_clock::now()) {
+        complete(work, -1, ETIMEDOUT);
+        return true;
+    }
+    switch (op) {
+    case operation::send_to:
+        return static_cast<io_send_to&>(work).ready();
+    case operation::recv_from:
+        return static_cast<io_recv_from&>(work).ready();
+    case operation::send:
+        return static_cast<io_send&>(work).ready();
+    case operation::recv:
+        return static_cast<io_recv&>(work).ready();
+    case operation::send_msg:
+        return static_cast<io_send_msg&>(work).ready();
+    case operation::recv_msg:
+        return static_cast<io_recv_msg&>(work).ready();
+    case operation::send_batch:
+        return static_cast<io_send_batch&>(work).ready();
+    case operation::recv_batch:
+        return static_cast<io_recv_batch&>(work).ready();
+    case operation::send_file:
+        return static_cast<io_send_file&>(work).ready();
+    case operation::splice_file:
+        return static_cast<io_splice_file&>(work).ready();
+    case operation::accept:
+        return static_cast<io_accept&>(work).ready();
+    case operation::connect:
+        return static_cast<io_connect&>(work).ready();
+    }
+    return false;
+}
+
+bool io_deadline::await_suspend(coroutine_handle<void> coro) noexcept(false) {
+    work.task = coro;
+    bool suspended = false;
+    switch (op) {
+    case operation::send_to:
+        suspended = static_cast<io_send_to&>(work).suspend(coro);
+        break;
+    case operation::recv_from:
+        suspended = static_cast<io_recv_from&>(work).suspend(coro);
+        break;
+    case operation::send:
+        suspended = static_cast<io_send&>(work).suspend(coro);
+        break;
+    case operation::recv:
+        suspended = static_cast<io_recv&>(work).suspend(coro);
+        break;
+    case operation::send_msg:
+        suspended = static_cast<io_send_msg&>(work).suspend(coro);
+        break;
+    case operation::recv_msg:
+        suspended = static_cast<io_recv_msg&>(work).suspend(coro);
+        break;
+    case operation::send_batch:
+        suspended = static_cast<io_send_batch&>(work).suspend(coro);
+        break;
+    case operation::recv_batch:
+        suspended = static_cast<io_recv_batch&>(work).suspend(coro);
+        break;
+    case operation::send_file:
+        suspended = static_cast<io_send_file&>(work).suspend(coro);
+        break;
+    case operation::splice_file:
+        suspended = static_cast<io_splice_file&>(work).suspend(coro);
+        break;
+    case operation::accept:
+        suspended = static_cast<io_accept&>(work).suspend(coro);
+        break;
+    case operation::connect:
+        suspended = static_cast<io_connect&>(work).suspend(coro);
+        break;
+    }
+    if (suspended == false)
+        return false;
+    if (until != steady_clock::time_point::max()) {
+        expiry = timer_wheel::to_tick(until);
+        task = coro;
+        on_expire = on_deadline;
+        get_timer_wheel().insert(*this);
+    }
+    if (token)
+        link(*token);
+    return true;
+}
+
+int64_t io_deadline::await_resume() noexcept {
+    io_timer::cancel();
+    unlink();
+    int64_t sz = -1;
+    switch (op) {
+    case operation::send_to:
+        sz = static_cast<io_send_to&>(work).resume();
+        break;
+    case operation::recv_from:
+        sz = static_cast<io_recv_from&>(work).resume();
+        break;
+    case operation::send:
+        sz = static_cast<io_send&>(work).resume();
+        break;
+    case operation::recv:
+        sz = static_cast<io_recv&>(work).resume();
+        break;
+    case operation::send_msg:
+        sz = static_cast<io_send_msg&>(work).resume();
+        break;
+    case operation::recv_msg:
+        sz = static_cast<io_recv_msg&>(work).resume();
+        break;
+    case operation::send_batch:
+        sz = static_cast<io_send_batch&>(work).resume();
+        break;
+    case operation::recv_batch:
+        sz = static_cast<io_recv_batch&>(work).resume();
+        break;
+    case operation::send_file:
+        sz = static_cast<io_send_file&>(work).resume();
+        break;
+    case operation::splice_file:
+        sz = static_cast<io_splice_file&>(work).resume();
+        break;
+    case operation::accept:
+        sz = static_cast<io_accept&>(work).resume();
+        break;
+    case operation::connect:
+        sz = static_cast<io_connect&>(work).resume();
+        break;
+    }
+    // io_uring reports `ECANCELED` for the both reasons
+    if (reason && work.error() == ECANCELED)
+        set_error(work, reason);
+    return sz;
+}
+
+auto send_to(uint64_t sd, const sockaddr_in& remote, io_buffer_t buffer,
+             io_work_t& work, steady_clock::time_point deadline,
+             io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_to(sd, remote, buffer, work);
+    return io_deadline{work, io_deadline::operation::send_to, deadline, token};
+}
+
+auto send_to(uint64_t sd, const sockaddr_in6& remote, io_buffer_t buffer,
+             io_work_t& work, steady_clock::time_point deadline,
+             io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_to(sd, remote, buffer, work);
+    return io_deadline{work, io_deadline::operation::send_to, deadline, token};
+}
+
+auto recv_from(uint64_t sd, sockaddr_in& remote, io_buffer_t buffer,
+               io_work_t& work, steady_clock::time_point deadline,
+               io_cancel_token* token) noexcept(false) -> io_deadline {
+    recv_from(sd, remote, buffer, work);
+    return io_deadline{work, io_deadline::operation::recv_from, deadline,
+                       token};
+}
+
+auto recv_from(uint64_t sd, sockaddr_in6& remote, io_buffer_t buffer,
+               io_work_t& work, steady_clock::time_point deadline,
+               io_cancel_token* token) noexcept(false) -> io_deadline {
+    recv_from(sd, remote, buffer, work);
+    return io_deadline{work, io_deadline::operation::recv_from, deadline,
+                       token};
+}
+
+auto send_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
+                 io_work_t& work, steady_clock::time_point deadline,
+                 io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_stream(sd, buffer, flag, work);
+    return io_deadline{work, io_deadline::operation::send, deadline, token};
+}
+
+auto recv_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
+                 io_work_t& work, steady_clock::time_point deadline,
+                 io_cancel_token* token) noexcept(false) -> io_deadline {
+    recv_stream(sd, buffer, flag, work);
+    return io_deadline{work, io_deadline::operation::recv, deadline, token};
+}
+
+auto send_msg(uint64_t sd, const msghdr& msg, uint32_t flag, io_work_t& work,
+              steady_clock::time_point deadline,
+              io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_msg(sd, msg, flag, work);
+    return io_deadline{work, io_deadline::operation::send_msg, deadline,
+                       token};
+}
+
+auto recv_msg(uint64_t sd, msghdr& msg, uint32_t flag, io_work_t& work,
+              steady_clock::time_point deadline,
+              io_cancel_token* token) noexcept(false) -> io_deadline {
+    recv_msg(sd, msg, flag, work);
+    return io_deadline{work, io_deadline::operation::recv_msg, deadline,
+                       token};
+}
+
+auto send_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work, steady_clock::time_point deadline,
+                io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_batch(sd, msgs, flag, work);
+    return io_deadline{work, io_deadline::operation::send_batch, deadline,
+                       token};
+}
+
+auto recv_batch(uint64_t sd, gsl::span<mmsghdr> msgs, uint32_t flag,
+                io_work_t& work, steady_clock::time_point deadline,
+                io_cancel_token* token) noexcept(false) -> io_deadline {
+    recv_batch(sd, msgs, flag, work);
+    return io_deadline{work, io_deadline::operation::recv_batch, deadline,
+                       token};
+}
+
+auto send_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+               io_work_t& work, steady_clock::time_point deadline,
+               io_cancel_token* token) noexcept(false) -> io_deadline {
+    send_file(sd, fd, offset, count, work);
+    return io_deadline{work, io_deadline::operation::send_file, deadline,
+                       token};
+}
+
+auto splice_file(uint64_t sd, int64_t fd, int64_t& offset, size_t count,
+                 io_pipe& pipe, io_work_t& work,
+                 steady_clock::time_point deadline,
+                 io_cancel_token* token) noexcept(false) -> io_deadline {
+    splice_file(sd, fd, offset, count, pipe, work);
+    return io_deadline{work, io_deadline::operation::splice_file, deadline,
+                       token};
+}
+
+auto accept(uint64_t ln, io_work_t& work, steady_clock::time_point deadline,
+            io_cancel_token* token) noexcept(false) -> io_deadline {
+    accept(ln, work);
+    return io_deadline{work, io_deadline::operation::accept, deadline, token};
+}
+
+auto accept(uint64_t ln, gsl::span<int64_t> sockets, io_work_t& work,
+            steady_clock::time_point deadline,
+            io_cancel_token* token) noexcept(false) -> io_deadline {
+    accept(ln, sockets, work);
+    return io_deadline{work, io_deadline::operation::accept, deadline, token};
+}
+
+auto connect(uint64_t sd, const sockaddr_in& remote, io_work_t& work,
+             steady_clock::time_point deadline,
+             io_cancel_token* token) noexcept(false) -> io_deadline {
+    connect(sd, remote, work);
+    return io_deadline{work, io_deadline::operation::connect, deadline,
+                       token};
+}
+
+auto connect(uint64_t sd, const sockaddr_in6& remote, io_work_t& work,
+             steady_clock::time_point deadline,
+             io_cancel_token* token) noexcept(false) -> io_deadline {
+    connect(sd, remote, work);
+    return io_deadline{work, io_deadline::operation::connect, deadline,
+                       token};
+}
+
 } // namespace coro
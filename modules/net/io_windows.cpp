@@ -110,9 +110,13 @@ auto send_to(uint64_t sd, const sockaddr_in& remote, io_buffer_t buffer,
     return *reinterpret_cast<io_send_to*>(addressof(work));
 }
 
+bool io_send_to::ready() noexcept {
+    return io_work_t::ready();
+}
+
 GSL_SUPPRESS(type .1)
 GSL_SUPPRESS(bounds .3)
-void io_send_to::suspend(coroutine_handle<void> t) noexcept(false) {
+bool io_send_to::suspend(coroutine_handle<void> t) noexcept(false) {
     task = t; // coroutine will be resumed in overlapped callback
 
     const auto sd = reinterpret_cast<SOCKET>(hEvent);
@@ -125,14 +129,15 @@ void io_send_to::suspend(coroutine_handle<void> t) noexcept(false) {
     if (::WSASendTo(sd, bufs, 1, nullptr, flag, //
                     addr, addrlen,              //
                     p, on_io_done) == NO_ERROR)
-        return;
+        return true;
 
     if (const auto ec = WSAGetLastError()) {
         if (is_async_pending(ec))
-            return;
+            return true;
 
         throw system_error{ec, system_category(), "WSASendTo"};
     }
+    return true;
 }
 
 int64_t io_send_to::resume() noexcept {
@@ -167,9 +172,13 @@ auto recv_from(uint64_t sd, sockaddr_in& remote, io_buffer_t buffer,
     return *reinterpret_cast<io_recv_from*>(addressof(work));
 }
 
+bool io_recv_from::ready() noexcept {
+    return io_work_t::ready();
+}
+
 GSL_SUPPRESS(type .1)
 GSL_SUPPRESS(bounds .3)
-void io_recv_from::suspend(coroutine_handle<void> t) noexcept(false) {
+bool io_recv_from::suspend(coroutine_handle<void> t) noexcept(false) {
     task = t; // coroutine will be resumed in overlapped callback
 
     const auto sd = reinterpret_cast<SOCKET>(hEvent);
@@ -182,14 +191,15 @@ void io_recv_from::suspend(coroutine_handle<void> t) noexcept(false) {
     if (::WSARecvFrom(sd, bufs, 1, nullptr, &flag, //
                       addr, &addrlen,              //
                       p, on_io_done) == NO_ERROR)
-        return;
+        return true;
 
     if (const auto ec = WSAGetLastError()) {
         if (is_async_pending(ec))
-            return;
+            return true;
 
         throw system_error{ec, system_category(), "WSARecvFrom"};
     }
+    return true;
 }
 
 int64_t io_recv_from::resume() noexcept {
@@ -208,9 +218,13 @@ auto send_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
     return *reinterpret_cast<io_send*>(addressof(work));
 }
 
+bool io_send::ready() noexcept {
+    return io_work_t::ready();
+}
+
 GSL_SUPPRESS(type .1)
 GSL_SUPPRESS(bounds .3)
-void io_send::suspend(coroutine_handle<void> t) noexcept(false) {
+bool io_send::suspend(coroutine_handle<void> t) noexcept(false) {
     task = t; // coroutine will be resumed in overlapped callback
 
     const auto sd = reinterpret_cast<SOCKET>(hEvent);
@@ -219,14 +233,15 @@ void io_send::suspend(coroutine_handle<void> t) noexcept(false) {
 
     if (::WSASend(sd, bufs, 1, nullptr, flag, //
                   zero_overlapped(this), on_io_done) == NO_ERROR)
-        return;
+        return true;
 
     if (const auto ec = WSAGetLastError()) {
         if (is_async_pending(ec))
-            return;
+            return true;
 
         throw system_error{ec, system_category(), "WSASend"};
     }
+    return true;
 }
 
 int64_t io_send::resume() noexcept {
@@ -245,9 +260,13 @@ auto recv_stream(uint64_t sd, io_buffer_t buffer, uint32_t flag,
     return *reinterpret_cast<io_recv*>(addressof(work));
 }
 
+bool io_recv::ready() noexcept {
+    return io_work_t::ready();
+}
+
 GSL_SUPPRESS(type .1)
 GSL_SUPPRESS(bounds .3)
-void io_recv::suspend(coroutine_handle<void> t) noexcept(false) {
+bool io_recv::suspend(coroutine_handle<void> t) noexcept(false) {
     task = t; // coroutine will be resumed in overlapped callback
 
     const auto sd = reinterpret_cast<SOCKET>(hEvent);
@@ -256,14 +275,15 @@ void io_recv::suspend(coroutine_handle<void> t) noexcept(false) {
 
     if (::WSARecv(sd, bufs, 1, nullptr, &flag, //
                   zero_overlapped(this), on_io_done) == NO_ERROR)
-        return;
+        return true;
 
     if (const auto ec = WSAGetLastError()) {
         if (is_async_pending(ec))
-            return;
+            return true;
 
         throw system_error{ec, system_category(), "WSARecv"};
     }
+    return true;
 }
 
 int64_t io_recv::resume() noexcept {
@@ -2,7 +2,6 @@
  * @author github.com/luncliff (luncliff@gmail.com)
  */
 #include <coroutine/net.h>
-#include <coroutine/yield.hpp>
 
 using namespace std;
 namespace coro {
@@ -29,32 +28,17 @@ uint32_t get_name(const sockaddr_in6& addr, //
                          flags);
 }
 
-auto get_address(addrinfo* list) noexcept -> enumerable<sockaddr*> {
-    auto on_return = gsl::finally([list]() noexcept {
-        // RAII clean up for the assigned addrinfo
-        ::freeaddrinfo(list);
-    });
-    for (addrinfo* it = list; it != nullptr; it = it->ai_next) {
-        co_yield it->ai_addr;
-    }
-}
-
-auto get_address(addrinfo* list, sockaddr_in addr) noexcept
-    -> enumerable<sockaddr_in> {
-    for (sockaddr* item : get_address(list)) {
-        const auto* ptr = reinterpret_cast<sockaddr_in*>(item);
-        addr = *ptr;
-        co_yield addr;
-    }
-}
-
-auto get_address(addrinfo* list, sockaddr_in6 addr) noexcept
-    -> enumerable<sockaddr_in6> {
-    for (sockaddr* item : get_address(list)) {
-        const auto* ptr = reinterpret_cast<sockaddr_in6*>(item);
-        addr = *ptr;
-        co_yield addr;
-    }
+/**
+ * @brief Copy the addresses in the list, then free it
+ */
+template <typename T>
+static uint32_t copy_address(addrinfo* list, gsl::span<T> output) noexcept {
+    ptrdiff_t i = 0;
+    for (auto* it = list; it != nullptr && i < output.size(); it = it->ai_next)
+        if (it->ai_addrlen == sizeof(T))
+            output[i++] = *reinterpret_cast<const T*>(it->ai_addr);
+    ::freeaddrinfo(list);
+    return 0;
 }
 
 uint32_t get_address(const addrinfo& hint, //
@@ -64,13 +48,7 @@ uint32_t get_address(const addrinfo& hint, //
     if (const auto ec = ::getaddrinfo(host, serv, //
                                       &hint, &list))
         return ec; // std::system_error{ec, system_category(), ::gai_strerror(ec)};
-    auto i = 0u;
-    for (auto addr : get_address(list, sockaddr_in{})) {
-        output[i++] = addr;
-        if (i == output.size())
-            break;
-    }
-    return 0;
+    return copy_address(list, output);
 }
 
 uint32_t get_address(const addrinfo& hint, //
@@ -80,13 +58,7 @@ uint32_t get_address(const addrinfo& hint, //
     if (const auto ec = ::getaddrinfo(host, serv, //
                                       &hint, &list))
         return ec;
-    auto i = 0u;
-    for (auto addr : get_address(list, sockaddr_in6{})) {
-        output[i++] = addr;
-        if (i == output.size())
-            break;
-    }
-    return 0;
+    return copy_address(list, output);
 }
 
 } // namespace coro
@@ -0,0 +1,193 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#include "timer_wheel.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace coro {
+
+static void unlink(io_timer& timer) noexcept {
+    timer.prev->next = timer.next;
+    timer.next->prev = timer.prev;
+    timer.next = timer.prev = nullptr;
+}
+
+static void push_back(io_timer& list, io_timer& timer) noexcept {
+    timer.prev = list.prev;
+    timer.next = addressof(list);
+    list.prev->next = addressof(timer);
+    list.prev = addressof(timer);
+}
+
+static bool empty(const io_timer& list) noexcept {
+    return list.next == addressof(list);
+}
+
+timer_wheel::timer_wheel() noexcept : current{now()} {
+    for (auto& level : slots)
+        for (auto& list : level)
+            list.next = list.prev = addressof(list);
+}
+
+timer_wheel::~timer_wheel() noexcept {
+    // the coroutines are not resumed. just detach them from the sentinels
+    for (auto& level : slots)
+        for (auto& list : level)
+            while (empty(list) == false) {
+                auto& timer = *list.next;
+                unlink(timer);
+                timer.task = nullptr;
+            }
+}
+
+uint64_t timer_wheel::to_tick(steady_clock::time_point tp) noexcept {
+    // round up. the timer must not expire earlier than requested
+    const auto ms = ceil<milliseconds>(tp.time_since_epoch()).count();
+    return ms < 0 ? 0 : static_cast<uint64_t>(ms);
+}
+
+uint64_t timer_wheel::now() noexcept {
+    const auto ms = duration_cast<milliseconds>(
+        steady_clock::now().time_since_epoch());
+    return static_cast<uint64_t>(ms.count());
+}
+
+void timer_wheel::link(io_timer& timer) noexcept {
+    // the expired one will be handled in the next `expire`
+    const auto expiry = timer.expiry < current ? current : timer.expiry;
+    const auto delta = expiry - current;
+    for (auto level = 0u; level < level_count - 1; ++level) {
+        if (delta >> (level_bits * (level + 1)))
+            continue;
+        const auto index = (expiry >> (level_bits * level)) & slot_mask;
+        return push_back(slots[level][index], timer);
+    }
+    // too far. it will be moved again at the turn of the last level
+    constexpr auto last = level_count - 1;
+    const auto limit = (uint64_t{1} << (level_bits * level_count)) - 1;
+    const auto clamped = delta > limit ? current + limit : expiry;
+    const auto index = (clamped >> (level_bits * last)) & slot_mask;
+    push_back(slots[last][index], timer);
+}
+
+void timer_wheel::insert(io_timer& timer) noexcept {
+    if (count == 0) // nothing to cascade. skip the idle ticks
+        current = max(current, now());
+    link(timer);
+    ++count;
+}
+
+void timer_wheel::remove(io_timer& timer) noexcept {
+    unlink(timer);
+    --count;
+}
+
+uint64_t timer_wheel::cascade(uint32_t level) noexcept {
+    const auto index = (current >> (level_bits * level)) & slot_mask;
+    io_timer& list = slots[level][index];
+    while (empty(list) == false) {
+        auto& timer = *list.next;
+        unlink(timer);
+        link(timer);
+    }
+    return index;
+}
+
+auto timer_wheel::wait_time(uint64_t tick) const noexcept -> nanoseconds {
+    if (count == 0)
+        return nanoseconds::max();
+    // search the lowest level. if nothing, wake up at the next cascade
+    auto expiry = (current | slot_mask) + 1;
+    for (auto t = current; t < expiry; ++t) {
+        if (empty(slots[0][t & slot_mask]) == false) {
+            expiry = t;
+            break;
+        }
+    }
+    if (expiry <= tick)
+        return nanoseconds::zero();
+    return milliseconds{expiry - tick};
+}
+
+size_t timer_wheel::expire(uint64_t tick) noexcept(false) {
+    if (count == 0) {
+        current = max(current, tick + 1);
+        return 0;
+    }
+    io_timer expired{};
+    expired.next = expired.prev = addressof(expired);
+    for (; current <= tick; ++current) {
+        if ((current & slot_mask) == 0)
+            for (auto level = 1u; level < level_count; ++level)
+                if (cascade(level) != 0)
+                    break;
+        io_timer& list = slots[0][current & slot_mask];
+        while (empty(list) == false) {
+            auto& timer = *list.next;
+            unlink(timer);
+            push_back(expired, timer);
+        }
+    }
+    // resume after the update. the coroutines may insert/remove timers.
+    // the timers in `expired` are still counted, so `cancel` works for them
+    size_t resumed = 0;
+    try {
+        while (empty(expired) == false) {
+            auto& timer = *expired.next;
+            remove(timer);
+            ++resumed;
+            auto task = exchange(timer.task, nullptr);
+            if (timer.on_expire)
+                timer.on_expire(timer);
+            else
+                task.resume();
+        }
+    } catch (...) {
+        // move the remaining ones back. they will be resumed in the next
+        while (empty(expired) == false) {
+            auto& timer = *expired.next;
+            unlink(timer);
+            link(timer);
+        }
+        throw;
+    }
+    return resumed;
+}
+
+timer_wheel& get_timer_wheel() noexcept {
+    thread_local timer_wheel wheel{};
+    return wheel;
+}
+
+void io_timer::cancel() noexcept {
+    if (task == nullptr) // not in the wheel, or a sentinel of the lists
+        return;
+    get_timer_wheel().remove(*this);
+    task = nullptr;
+}
+
+io_sleep::io_sleep(steady_clock::time_point tp) noexcept
+    : io_timer{}, until{tp} {
+    expiry = timer_wheel::to_tick(tp);
+}
+
+bool io_sleep::await_ready() const noexcept {
+    return until <= steady_clock::now();
+}
+
+void io_sleep::await_suspend(coroutine_handle<void> coro) noexcept {
+    task = coro;
+    get_timer_wheel().insert(*this);
+}
+
+io_sleep sleep_until(steady_clock::time_point tp) noexcept {
+    return io_sleep{tp};
+}
+
+io_sleep sleep_for(steady_clock::duration duration) noexcept {
+    return io_sleep{steady_clock::now() + duration};
+}
+
+} // namespace coro
@@ -0,0 +1,79 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Hierarchical timing wheel for `io_timer`. Private to coroutine_net
+ */
+#pragma once
+#ifndef COROUTINE_NET_TIMER_WHEEL_H
+#define COROUTINE_NET_TIMER_WHEEL_H
+#include <chrono>
+
+#include <coroutine/net.h>
+
+namespace coro {
+
+/**
+ * @brief 4 levels of 256 slots with 1 millisecond tick
+ * @note  The wheel is per-thread. It is not thread-safe
+ *
+ * The slots are intrusive lists of `io_timer`, so insert/cancel are O(1).
+ * When the lower level wraps, a slot of the upper level is moved down.
+ * The timers beyond the last level (49 days) stay in the last level
+ * and are moved again at its turn.
+ */
+class timer_wheel final {
+  public:
+    static constexpr uint32_t level_bits = 8;
+    static constexpr uint32_t level_count = 4;
+    static constexpr uint64_t slot_count = uint64_t{1} << level_bits;
+    static constexpr uint64_t slot_mask = slot_count - 1;
+
+  private:
+    // sentinels of the lists
+    io_timer slots[level_count][slot_count]{};
+    uint64_t current = 0; // the next tick to be expired
+    size_t count = 0;
+
+  private:
+    void link(io_timer& timer) noexcept;
+    /**
+     * @brief Move the timers in the slot to the lower levels
+     * @return index of the slot. 0 if the upper level must be cascaded
+     */
+    uint64_t cascade(uint32_t level) noexcept;
+
+  public:
+    timer_wheel() noexcept;
+    ~timer_wheel() noexcept;
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel(timer_wheel&&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+    timer_wheel& operator=(timer_wheel&&) = delete;
+
+    static uint64_t to_tick(std::chrono::steady_clock::time_point tp) noexcept;
+    static uint64_t now() noexcept;
+
+    size_t size() const noexcept {
+        return count;
+    }
+    void insert(io_timer& timer) noexcept;
+    void remove(io_timer& timer) noexcept;
+    /**
+     * @brief Time to the next expiry. It may be earlier than the exact one
+     * @return nanoseconds::max() if there is no timer
+     */
+    auto wait_time(uint64_t tick) const noexcept -> std::chrono::nanoseconds;
+    /**
+     * @brief Resume the coroutines of the timers expired until the `tick`
+     * @return the number of the expired timers
+     */
+    size_t expire(uint64_t tick) noexcept(false);
+};
+
+/**
+ * @brief The timer wheel of the current thread
+ */
+timer_wheel& get_timer_wheel() noexcept;
+
+} // namespace coro
+
+#endif // COROUTINE_NET_TIMER_WHEEL_H
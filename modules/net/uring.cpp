@@ -0,0 +1,160 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#include "uring.h"
+
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace coro {
+
+static uint32_t load_acquire(const uint32_t* ptr) noexcept {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+static void store_release(uint32_t* ptr, uint32_t value) noexcept {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+uring_owner::uring_owner(uint32_t entries) noexcept(false) {
+    io_uring_params params{};
+    fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0)
+        throw system_error{errno, system_category(), "io_uring_setup"};
+    auto on_error = gsl::finally([this]() {
+        if (ring == nullptr || sqes == nullptr)
+            release();
+    });
+    constexpr auto required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required)
+        throw system_error{ENOSYS, system_category(), "io_uring_setup"};
+
+    // SQ and CQ share the mapping with IORING_FEAT_SINGLE_MMAP
+    ring_size = max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+                    params.cq_off.cqes +
+                        params.cq_entries * sizeof(io_uring_cqe));
+    void* ptr = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED)
+        throw system_error{errno, system_category(), "mmap"};
+    ring = ptr;
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED)
+        throw system_error{errno, system_category(), "mmap"};
+    sqes = static_cast<io_uring_sqe*>(ptr);
+
+    auto* base = static_cast<byte*>(ring);
+    sq_head = reinterpret_cast<uint32_t*>(base + params.sq_off.head);
+    sq_tail = reinterpret_cast<uint32_t*>(base + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<uint32_t*>(base + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    // the index array is identity. the SQEs are used in order
+    auto* sq_array = reinterpret_cast<uint32_t*>(base + params.sq_off.array);
+    for (auto i = 0u; i < sq_entries; ++i)
+        sq_array[i] = i;
+
+    cq_head = reinterpret_cast<uint32_t*>(base + params.cq_off.head);
+    cq_tail = reinterpret_cast<uint32_t*>(base + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<uint32_t*>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+}
+
+uring_owner::~uring_owner() noexcept {
+    release();
+}
+
+void uring_owner::release() noexcept {
+    if (sqes)
+        munmap(sqes, sqes_size);
+    if (ring)
+        munmap(ring, ring_size);
+    if (fd >= 0)
+        close(fd);
+    sqes = nullptr, ring = nullptr, fd = -1;
+}
+
+io_uring_sqe* uring_owner::get_sqe() noexcept(false) {
+    // only this object writes the tail
+    const auto tail = *sq_tail + prepared;
+    // `submit` may return without the consumption. EINTR, EBUSY, EAGAIN
+    for (auto retry = 0; tail - load_acquire(sq_head) >= sq_entries; ++retry) {
+        if (retry == 4)
+            throw system_error{EBUSY, system_category(), "io_uring_enter"};
+        stash_completions(); // for EBUSY
+        submit();
+    }
+    auto* sqe = sqes + (tail & sq_mask);
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    // visible to the kernel after the caller fills it and calls `submit`
+    ++prepared;
+    return sqe;
+}
+
+void uring_owner::submit() noexcept(false) {
+    // publish the prepared SQEs
+    const auto tail = *sq_tail + prepared;
+    store_release(sq_tail, tail);
+    prepared = 0;
+    // including the ones not consumed by the previous call
+    const auto count = tail - load_acquire(sq_head);
+    if (count == 0)
+        return;
+    if (syscall(__NR_io_uring_enter, fd, count, 0, 0, nullptr, 0) >= 0)
+        return;
+    switch (errno) {
+    case EINTR:
+    case EBUSY: // the completion queue is full. `reap` will make room
+    case EAGAIN:
+        return; // the remaining SQEs will be consumed with the next call
+    default:
+        throw system_error{errno, system_category(), "io_uring_enter"};
+    }
+}
+
+void uring_owner::wait(const __kernel_timespec* timeout) noexcept(false) {
+    io_uring_getevents_arg arg{};
+    arg.ts = reinterpret_cast<uint64_t>(timeout);
+    const auto flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    if (syscall(__NR_io_uring_enter, fd, 0, 1, flags, &arg, sizeof(arg)) >= 0)
+        return;
+    switch (errno) {
+    case ETIME:
+    case EINTR:
+        return;
+    default:
+        throw system_error{errno, system_category(), "io_uring_enter"};
+    }
+}
+
+void uring_owner::stash_completions() noexcept(false) {
+    auto head = *cq_head;
+    const auto tail = load_acquire(cq_tail);
+    stash.reserve(stash.size() + (tail - head));
+    for (; head != tail; ++head)
+        stash.emplace_back(cqes[head & cq_mask]);
+    store_release(cq_head, head);
+}
+
+size_t uring_owner::reap(gsl::span<io_uring_cqe> list) noexcept {
+    size_t count = 0;
+    for (; count < stash.size() && count < list.size(); ++count)
+        list[count] = stash[count];
+    stash.erase(stash.begin(), stash.begin() + count);
+
+    auto head = *cq_head;
+    const auto tail = load_acquire(cq_tail);
+    for (; head != tail && count < list.size(); ++head, ++count)
+        list[count] = cqes[head & cq_mask];
+    store_release(cq_head, head);
+    return count;
+}
+
+} // namespace coro
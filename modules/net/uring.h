@@ -0,0 +1,98 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `io_uring` with raw system calls. Private to coroutine_net
+ */
+#pragma once
+#ifndef COROUTINE_NET_URING_H
+#define COROUTINE_NET_URING_H
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#include <gsl/gsl>
+#include <vector>
+
+namespace coro {
+
+/**
+ * @brief RAII wrapping for `io_uring` instance
+ * @see io_uring_setup
+ * @see io_uring_enter
+ * @note The member functions are not thread-safe. The caller must serialize
+ *
+ * Requires `IORING_FEAT_SINGLE_MMAP` and `IORING_FEAT_EXT_ARG` (Linux 5.11)
+ */
+class uring_owner final {
+    int64_t fd = -1;
+    void* ring = nullptr;
+    size_t ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    uint32_t* sq_head = nullptr;
+    uint32_t* sq_tail = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t sq_entries = 0;
+    uint32_t prepared = 0; // filled, but not submitted
+
+    uint32_t* cq_head = nullptr;
+    uint32_t* cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+    // moved out of the CQ to make room for the submission. `reap` returns first
+    std::vector<io_uring_cqe> stash{};
+
+  private:
+    void release() noexcept;
+    void stash_completions() noexcept(false);
+
+  public:
+    /**
+     * @param entries hint for the queue size
+     * @throw system_error
+     */
+    explicit uring_owner(uint32_t entries) noexcept(false);
+    ~uring_owner() noexcept;
+    uring_owner(const uring_owner&) = delete;
+    uring_owner(uring_owner&&) = delete;
+    uring_owner& operator=(const uring_owner&) = delete;
+    uring_owner& operator=(uring_owner&&) = delete;
+
+  public:
+    /**
+     * @brief Zero-filled SQE to prepare. It is submitted with the next `submit`
+     * @note  If the queue is full, the prepared SQEs are submitted first.
+     *        The slot is returned only after the kernel consumed it
+     * @throw system_error `EBUSY` if the kernel doesn't consume the queue
+     */
+    io_uring_sqe* get_sqe() noexcept(false);
+
+    /**
+     * @brief Submit the prepared SQEs without waiting
+     * @throw system_error
+     */
+    void submit() noexcept(false);
+
+    /**
+     * @brief Wait for at least 1 completion
+     * @param timeout `nullptr` for infinite
+     * @throw system_error
+     *
+     * It doesn't touch the queues, so it can be used without the caller's
+     * serialization. Timeout and interruption are not errors for this function
+     */
+    void wait(const __kernel_timespec* timeout) noexcept(false);
+
+    /**
+     * @brief Move the completions out of the queue
+     * @return size_t number of the CQEs in the `list`
+     */
+    size_t reap(gsl::span<io_uring_cqe> list) noexcept;
+
+    uint32_t pending() const noexcept {
+        return prepared;
+    }
+};
+
+} // namespace coro
+
+#endif // COROUTINE_NET_URING_H
@@ -148,14 +148,17 @@ bool portable_coro_done(portable_coro_prefix* _Handle) {
 }
 
 void portable_coro_resume(portable_coro_prefix* _Handle) {
+    COROUTINE_TRACE_POINT(resume_begin, _Handle);
     if constexpr (is_msvc) {
         _coro_resume(_Handle);
     } else if constexpr (is_clang) {
        resume_wrapper<true>(_Handle); 
     }
+    COROUTINE_TRACE_POINT(resume_end, _Handle);
 }
 
 void portable_coro_destroy(portable_coro_prefix* _Handle) {
+    COROUTINE_TRACE_POINT(destroy, _Handle);
     if constexpr (is_msvc) {
         _coro_destroy(_Handle);
     } else if constexpr (is_clang) {
@@ -0,0 +1,24 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#include "coroutine/frame_stat.h"
+
+using namespace std;
+
+namespace coro {
+
+static atomic<const frame_stat*> frame_stats{};
+
+void frame_stat_register(frame_stat& stat) noexcept {
+    stat.next = frame_stats.load(memory_order_relaxed);
+    while (frame_stats.compare_exchange_weak(stat.next, &stat,       //
+                                             memory_order_release, //
+                                             memory_order_relaxed) == false)
+        ;
+}
+
+auto frame_stat_list() noexcept -> const frame_stat* {
+    return frame_stats.load(memory_order_acquire);
+}
+
+} // namespace coro
@@ -0,0 +1,218 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#include "coroutine/trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace coro {
+
+/**
+ * @brief `trace_event` which can be read while its owner is writing
+ * @see trace_dump
+ */
+struct trace_slot final {
+    atomic<uint64_t> timestamp{};
+    atomic<const void*> address{};
+    atomic<trace_kind> kind{};
+};
+
+/**
+ * @brief Single producer ring buffer for 1 thread
+ * @details
+ * Buffers are linked into a list and never deallocated.
+ * When its thread exits, the buffer is released and the next new thread
+ * reuses it. So the number of buffers follows the peak thread count.
+ */
+struct trace_buffer final {
+    static constexpr size_t capacity = 1 << 14;
+
+    trace_buffer* next = nullptr;
+    atomic_bool owned{true};
+    atomic<uint64_t> tid{};
+    atomic<uint64_t> count{}; // total written. `count % capacity` is the head
+    atomic<uint64_t> generation{}; // `trace_generation` of the last reset
+    atomic<uint64_t> resets{};     // increased before the `count` is reset
+    array<trace_slot, capacity> events{};
+};
+
+static atomic<trace_buffer*> trace_buffers{};
+static atomic<uint64_t> trace_generation{}; // increased by `trace_clear`
+
+const auto trace_epoch = steady_clock::now();
+
+static uint64_t get_current_tid() noexcept {
+    // Chrome trace viewer expects a small number
+    return hash<thread::id>{}(this_thread::get_id()) & 0xFFFF'FFFF;
+}
+
+static auto acquire_trace_buffer() noexcept -> trace_buffer* {
+    // reuse a buffer of the exited thread
+    for (auto* b = trace_buffers.load(memory_order_acquire); b; b = b->next) {
+        bool owned = false;
+        if (b->owned.compare_exchange_strong(owned, true))
+            return b;
+    }
+    // lock-free push to the list
+    auto* b = new (nothrow) trace_buffer{};
+    if (b == nullptr)
+        return nullptr;
+    b->next = trace_buffers.load(memory_order_relaxed);
+    while (trace_buffers.compare_exchange_weak(b->next, b,          //
+                                               memory_order_release, //
+                                               memory_order_relaxed) == false)
+        ;
+    return b;
+}
+
+/**
+ * @brief Binds a `trace_buffer` to the current thread
+ */
+class trace_buffer_owner final {
+    trace_buffer* buffer;
+
+  public:
+    trace_buffer_owner() noexcept : buffer{acquire_trace_buffer()} {
+        if (buffer == nullptr)
+            return;
+        reset();
+        buffer->tid.store(get_current_tid(), memory_order_release);
+    }
+    ~trace_buffer_owner() noexcept {
+        // keep the events. they will be cleared on the next acquisition
+        if (buffer)
+            buffer->owned.store(false, memory_order_release);
+    }
+    /**
+     * @brief Discard the events. Only the owner thread writes the `count`
+     */
+    void reset() noexcept {
+        // `trace_dump` drops the events it read across this
+        buffer->resets.fetch_add(1, memory_order_relaxed);
+        buffer->count.store(0, memory_order_relaxed);
+        // `trace_dump` reads the `count` after this
+        buffer->generation.store(trace_generation.load(memory_order_acquire),
+                                 memory_order_release);
+    }
+    trace_buffer* get() const noexcept {
+        return buffer;
+    }
+};
+
+void trace_record(trace_kind kind, const void* address) noexcept {
+    thread_local trace_buffer_owner owner{};
+    trace_buffer* b = owner.get();
+    if (b == nullptr)
+        return;
+    if (b->generation.load(memory_order_relaxed) !=
+        trace_generation.load(memory_order_acquire))
+        owner.reset(); // `trace_clear` was requested
+
+    const auto index = b->count.load(memory_order_relaxed);
+    auto& e = b->events[index % trace_buffer::capacity];
+    // the `count` and `resets` above are visible before the slot changes
+    atomic_thread_fence(memory_order_release);
+    const auto elapsed = steady_clock::now() - trace_epoch;
+    e.timestamp.store(static_cast<uint64_t>(
+                          duration_cast<nanoseconds>(elapsed).count()),
+                      memory_order_relaxed);
+    e.address.store(address, memory_order_relaxed);
+    e.kind.store(kind, memory_order_relaxed);
+    // publish the event to `trace_dump`
+    b->count.store(index + 1, memory_order_release);
+}
+
+void trace_clear() noexcept {
+    trace_generation.fetch_add(1, memory_order_acq_rel);
+}
+
+bool trace_is_enabled() noexcept {
+#if defined(USE_COROUTINE_TRACE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @see Trace Event Format, "Duration Events" and "Instant Events"
+ */
+static auto get_trace_name(trace_kind kind, const char*& phase) noexcept
+    -> const char* {
+    switch (kind) {
+    case trace_kind::create:
+        phase = "i";
+        return "create";
+    case trace_kind::resume_begin:
+        phase = "B";
+        return "resume";
+    case trace_kind::resume_end:
+        phase = "E";
+        return "resume";
+    case trace_kind::final:
+        phase = "i";
+        return "final";
+    case trace_kind::destroy:
+        phase = "i";
+        return "destroy";
+    }
+    phase = "i";
+    return "unknown";
+}
+
+size_t trace_dump(FILE* stream) noexcept {
+    size_t written = 0;
+    fputs("{\"traceEvents\":[", stream);
+    const auto generation = trace_generation.load(memory_order_acquire);
+    for (auto* b = trace_buffers.load(memory_order_acquire); b; b = b->next) {
+        const auto resets = b->resets.load(memory_order_acquire);
+        // cleared, but its owner didn't record after that
+        if (b->generation.load(memory_order_acquire) != generation)
+            continue;
+        const auto tid = b->tid.load(memory_order_acquire);
+        const auto count = b->count.load(memory_order_acquire);
+        // oldest event in the ring
+        const auto first =
+            count > trace_buffer::capacity ? count - trace_buffer::capacity : 0;
+
+        for (auto i = first; i < count; ++i) {
+            const auto& slot = b->events[i % trace_buffer::capacity];
+            trace_event e{};
+            e.timestamp = slot.timestamp.load(memory_order_relaxed);
+            e.address = slot.address.load(memory_order_relaxed);
+            e.kind = slot.kind.load(memory_order_relaxed);
+            // pairs with the fence in `trace_record`. if the copy has a newer
+            // write, the `count` or `resets` below shows it
+            atomic_thread_fence(memory_order_acquire);
+            if (b->resets.load(memory_order_relaxed) != resets)
+                break; // reused by another thread, or cleared
+            // the owner is writing (or wrote) the event `i + capacity` there
+            const auto latest = b->count.load(memory_order_relaxed);
+            if (latest >= i + trace_buffer::capacity)
+                continue;
+            const char* phase = nullptr;
+            const char* name = get_trace_name(e.kind, phase);
+            fprintf(stream,
+                    "%s\n{\"name\":\"%s\",\"cat\":\"coroutine\",\"ph\":\"%s\","
+                    "\"ts\":%.3f,\"pid\":0,\"tid\":%llu,%s"
+                    "\"args\":{\"address\":\"%p\"}}",
+                    written ? "," : "", name, phase, e.timestamp / 1000.0,
+                    static_cast<unsigned long long>(tid),
+                    phase[0] == 'i' ? "\"s\":\"t\"," : "", e.address);
+            ++written;
+        }
+    }
+    fputs("\n]}\n", stream);
+    fflush(stream);
+    return written;
+}
+
+} // namespace coro
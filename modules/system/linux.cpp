@@ -5,9 +5,13 @@
 
 #include <fcntl.h>
 #include <sys/eventfd.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
+#include <linux/time_types.h>
+
 using namespace std;
+using namespace std::chrono;
 
 namespace coro {
 
@@ -50,6 +54,35 @@ ptrdiff_t epoll_owner::wait(uint32_t wait_ms,
     return count;
 }
 
+// `false` if the kernel returned `ENOSYS` for `epoll_pwait2`
+static atomic_bool epoll_pwait2_supported{true};
+
+ptrdiff_t epoll_owner::wait(nanoseconds timeout,
+                            gsl::span<epoll_event> output) noexcept(false) {
+#if defined(SYS_epoll_pwait2)
+    if (epoll_pwait2_supported.load(memory_order_relaxed)) {
+        __kernel_timespec ts{};
+        ts.tv_sec = duration_cast<seconds>(timeout).count();
+        ts.tv_nsec = (timeout % seconds{1}).count();
+        auto count = syscall(SYS_epoll_pwait2, epfd, output.data(),
+                             output.size(),
+                             timeout.count() < 0 ? nullptr : &ts, nullptr, 0);
+        if (count >= 0)
+            return count;
+        if (errno != ENOSYS)
+            throw system_error{errno, system_category(), "epoll_pwait2"};
+        epoll_pwait2_supported.store(false, memory_order_relaxed);
+    }
+#endif
+    if (timeout.count() < 0)
+        return this->wait(static_cast<uint32_t>(-1), output);
+    // round up. or short timeouts will become busy waiting
+    const auto wait_ms = ceil<milliseconds>(timeout);
+    return this->wait(
+        static_cast<uint32_t>(min<int64_t>(wait_ms.count(), INT32_MAX)),
+        output);
+}
+
 //
 //  We are going to combine file descriptor and state bit
 //
@@ -130,4 +163,100 @@ void event::reset() noexcept(false) {
     this->state = static_cast<uint64_t>(fd);
 }
 
+static thread_local event_loop* current_loop = nullptr;
+
+event_loop* event_loop::current() noexcept {
+    return current_loop;
+}
+
+event_loop::event_loop() noexcept(false)
+    : efd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)} {
+    if (efd == -1)
+        throw system_error{errno, system_category(), "eventfd"};
+    // level-triggered. `data.ptr` of the loop itself indicates the wake-up
+    epoll_event req{};
+    req.events = EPOLLIN;
+    req.data.ptr = this;
+    try {
+        ep.try_add(static_cast<uint64_t>(efd), req);
+    } catch (...) {
+        close(efd);
+        throw;
+    }
+}
+
+event_loop::~event_loop() noexcept {
+    close(efd);
+}
+
+void event_loop::post(schedule_awaiter* task) noexcept(false) {
+    auto* head = posted.load(memory_order_relaxed);
+    do {
+        task->next = head;
+    } while (posted.compare_exchange_weak(head, task, memory_order_release,
+                                          memory_order_relaxed) == false);
+    // `task` may be resumed from here. don't touch it.
+    // the consumer will see the others. wake only for the first one
+    if (head == nullptr)
+        notify_event(efd);
+}
+
+uint32_t event_loop::drain() noexcept(false) {
+    auto* list = posted.exchange(nullptr, memory_order_acquire);
+    // the stack is LIFO. reverse it for the FIFO order
+    schedule_awaiter* fifo = nullptr;
+    while (list) {
+        auto* next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+    uint32_t count = 0;
+    while (fifo) {
+        // the awaiter is in the coroutine frame. read it before the resume
+        auto* next = fifo->next;
+        fifo->coro.resume();
+        fifo = next;
+        ++count;
+    }
+    return count;
+}
+
+uint32_t event_loop::run_once(uint32_t wait_ms) noexcept(false) {
+    auto* prev_loop = current_loop;
+    current_loop = this;
+    auto on_return = gsl::finally([prev_loop]() { current_loop = prev_loop; });
+
+    uint32_t count = drain();
+    // don't block if there was something to do
+    const auto timeout = count ? 0 : wait_ms;
+    const auto num_events = ep.wait(timeout, events);
+    for (auto i = 0; i < num_events; ++i) {
+        void* ptr = events[i].data.ptr;
+        if (ptr == this) {
+            // nothing to worry about the remaining counter.
+            // `post` writes again after the `drain`
+            int64_t value{};
+            if (read(efd, &value, sizeof(value)) == -1 && errno != EAGAIN)
+                throw system_error{errno, system_category(), "read"};
+            continue;
+        }
+        if (auto coro = coroutine_handle<void>::from_address(ptr)) {
+            coro.resume();
+            ++count;
+        }
+    }
+    return count + drain();
+}
+
+void event_loop::run() noexcept(false) {
+    while (is_stopped() == false)
+        run_once(UINT32_MAX); // infinite. `stop` will wake up the loop
+}
+
+void event_loop::stop() noexcept(false) {
+    stopped.store(true, memory_order_release);
+    notify_event(efd);
+}
+
 } // namespace coro
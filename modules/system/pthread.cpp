@@ -3,6 +3,10 @@
  */
 #include <coroutine/pthread.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 namespace coro {
 using namespace std;
 
@@ -21,6 +25,149 @@ continue_on_pthread::spawn(pthread_t& tid, const pthread_attr_t* attr,
     return ::pthread_create(&tid, attr, on_pthread, coro.address());
 }
 
+/**
+ * @brief Attributes of `pthread_attr_t` to find an equivalent thread
+ */
+struct pthread_attr_key final {
+    size_t stack_size{};
+    size_t guard_size{};
+    int policy{};
+    int priority{};
+    int inherit{};
+    int scope{};
+#if defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t affinity{};
+#endif
+
+    bool operator==(const pthread_attr_key& rhs) const noexcept {
+        return stack_size == rhs.stack_size && guard_size == rhs.guard_size &&
+               policy == rhs.policy && priority == rhs.priority &&
+               inherit == rhs.inherit && scope == rhs.scope
+#if defined(__linux__) && !defined(__ANDROID__)
+               && CPU_EQUAL(&affinity, &rhs.affinity)
+#endif
+            ;
+    }
+};
+
+static auto make_attr_key(const pthread_attr_t* attr) noexcept(false)
+    -> pthread_attr_key {
+    pthread_attr_t fallback{};
+    if (attr == nullptr) {
+        if (auto ec = pthread_attr_init(&fallback))
+            throw system_error{ec, system_category(), "pthread_attr_init"};
+        attr = &fallback;
+    }
+    pthread_attr_key key{};
+    sched_param param{};
+    pthread_attr_getstacksize(attr, &key.stack_size);
+    pthread_attr_getguardsize(attr, &key.guard_size);
+    pthread_attr_getschedpolicy(attr, &key.policy);
+    pthread_attr_getschedparam(attr, &param);
+    pthread_attr_getinheritsched(attr, &key.inherit);
+    pthread_attr_getscope(attr, &key.scope);
+    key.priority = param.sched_priority;
+#if defined(__linux__) && !defined(__ANDROID__)
+    pthread_attr_getaffinity_np(attr, sizeof(key.affinity), &key.affinity);
+#endif
+    if (attr == &fallback)
+        pthread_attr_destroy(&fallback);
+    return key;
+}
+
+/**
+ * @brief Parked thread for `continue_on_pooled_pthread`
+ * @note  The object is never deleted. `pthread_joiner` may wait on it anytime
+ */
+class pthread_worker final {
+  public:
+    const pthread_attr_key key;
+    pthread_t tid{};
+    mutex mtx{};
+    condition_variable cv{};
+    void* task = nullptr;  // coroutine frame to resume. guarded by `mtx`
+    uint32_t finished = 0; // number of the resumptions. guarded by `mtx`
+
+  public:
+    explicit pthread_worker(const pthread_attr_key& _key) noexcept
+        : key{_key} {
+    }
+
+    static void* on_pthread(void* ptr) noexcept(false);
+};
+
+static mutex idle_mtx{};
+// never shrinks. the threads stay parked until the process exits
+static vector<pthread_worker*> idle_workers{};
+
+void* pthread_worker::on_pthread(void* ptr) noexcept(false) {
+    auto* w = static_cast<pthread_worker*>(ptr);
+    while (true) {
+        unique_lock lck{w->mtx};
+        w->cv.wait(lck, [w]() { return w->task != nullptr; });
+        auto task = coroutine_handle<void>::from_address(w->task);
+        w->task = nullptr;
+        lck.unlock();
+
+        if (task.done() == false)
+            task.resume();
+
+        lck.lock();
+        w->finished += 1;
+        {
+            // ready for the next `co_await` before the joiner wakes up.
+            // `submit` will read the `finished` after `lck` is released
+            unique_lock idle_lck{idle_mtx};
+            idle_workers.emplace_back(w);
+        }
+        lck.unlock();
+        w->cv.notify_all(); // for the `pthread_joiner`
+    }
+}
+
+uint32_t continue_on_pooled_pthread::submit(
+    pthread_t& tid, pthread_worker*& worker, uint32_t& ticket,
+    const pthread_attr_t* attr, coroutine_handle<void> coro) noexcept(false) {
+    const auto key = make_attr_key(attr);
+    pthread_worker* w = nullptr;
+    {
+        unique_lock lck{idle_mtx};
+        // search from the recently parked one. its stack is warm
+        for (auto it = idle_workers.rbegin(); it != idle_workers.rend(); ++it) {
+            if ((*it)->key == key) {
+                w = *it;
+                idle_workers.erase(next(it).base());
+                break;
+            }
+        }
+    }
+    if (w == nullptr) {
+        w = new pthread_worker{key};
+        if (auto ec = ::pthread_create(&w->tid, attr, //
+                                       pthread_worker::on_pthread, w)) {
+            delete w;
+            return ec;
+        }
+        // the thread never exits. nobody joins it
+        pthread_detach(w->tid);
+    }
+    // the outputs must be ready before the coroutine is resumed
+    unique_lock lck{w->mtx};
+    tid = w->tid;
+    worker = w;
+    ticket = w->finished;
+    w->task = coro.address();
+    lck.unlock();
+    w->cv.notify_all();
+    return 0;
+}
+
+void continue_on_pooled_pthread::wait(pthread_worker* w,
+                                      uint32_t ticket) noexcept {
+    unique_lock lck{w->mtx};
+    w->cv.wait(lck, [w, ticket]() { return w->finished != ticket; });
+}
+
 pthread_joiner::pthread_joiner(promise_type* p) noexcept(false) : promise{p} {
     if (p == nullptr)
         throw invalid_argument{"nullptr for promise_type*"};
@@ -31,6 +178,13 @@ pthread_joiner::~pthread_joiner() noexcept(false) {
     if (tid == pthread_t{}) // spawned no threads. nothing to do
         return;
 
+    if (promise->worker) {
+        // the thread is parked after the resumption. wait for it
+        continue_on_pooled_pthread::wait(promise->worker, promise->ticket);
+        auto* p = static_cast<promise_type*>(promise);
+        coroutine_handle<promise_type>::from_promise(*p).destroy();
+        return;
+    }
     void* ptr{};
     // we must acquire `tid` before the destruction
     if (auto ec = pthread_join(tid, &ptr)) {
@@ -51,6 +205,8 @@ pthread_detacher::~pthread_detacher() noexcept(false) {
     pthread_t tid = *this;
     if (tid == pthread_t{}) // spawned no threads. nothing to do
         return;
+    if (promise->worker) // pooled thread. it is already detached
+        return;
 
     if (auto ec = pthread_detach(tid)) {
         throw system_error{ec, system_category(), "pthread_join"};
@@ -0,0 +1,242 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#include <coroutine/linux.h>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <thread>
+
+using namespace std;
+
+namespace coro {
+
+/**
+ * @brief Chase-Lev deque of coroutine frames
+ *
+ * The owner pushes and takes at the bottom. The others steal from the top.
+ * When the ring is full, the owner doubles it. The old rings are kept until
+ * the deque is destroyed because the thieves may be reading them.
+ */
+class work_deque final {
+    struct ring final {
+        const int64_t capacity;
+        unique_ptr<atomic<void*>[]> items;
+
+        explicit ring(int64_t _capacity) noexcept(false)
+            : capacity{_capacity}, items{new atomic<void*>[_capacity]} {
+        }
+        void* get(int64_t i) const noexcept {
+            return items[i & (capacity - 1)].load(memory_order_relaxed);
+        }
+        void put(int64_t i, void* ptr) noexcept {
+            items[i & (capacity - 1)].store(ptr, memory_order_relaxed);
+        }
+    };
+
+    alignas(64) atomic<int64_t> top{};
+    alignas(64) atomic<int64_t> bottom{};
+    atomic<ring*> current;
+    vector<unique_ptr<ring>> rings{}; // owner only
+
+  public:
+    work_deque() noexcept(false) {
+        rings.emplace_back(make_unique<ring>(256));
+        current.store(rings.back().get(), memory_order_relaxed);
+    }
+
+    void push(void* ptr) noexcept(false) {
+        const auto b = bottom.load(memory_order_relaxed);
+        const auto t = top.load(memory_order_acquire);
+        auto* r = current.load(memory_order_relaxed);
+        if (b - t > r->capacity - 1) {
+            rings.emplace_back(make_unique<ring>(r->capacity * 2));
+            auto* larger = rings.back().get();
+            for (auto i = t; i < b; ++i)
+                larger->put(i, r->get(i));
+            current.store(larger, memory_order_release);
+            r = larger;
+        }
+        r->put(b, ptr);
+        atomic_thread_fence(memory_order_release);
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+
+    void* take() noexcept {
+        const auto b = bottom.load(memory_order_relaxed) - 1;
+        auto* r = current.load(memory_order_relaxed);
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        auto t = top.load(memory_order_relaxed);
+        if (t > b) { // empty
+            bottom.store(b + 1, memory_order_relaxed);
+            return nullptr;
+        }
+        void* ptr = r->get(b);
+        if (t == b) {
+            // the last one. compete with the thieves
+            if (top.compare_exchange_strong(t, t + 1, memory_order_seq_cst,
+                                            memory_order_relaxed) == false)
+                ptr = nullptr;
+            bottom.store(b + 1, memory_order_relaxed);
+        }
+        return ptr;
+    }
+
+    /**
+     * @param contended set if the race is lost to the others
+     * @return `nullptr` if there is nothing to steal
+     */
+    void* steal(bool& contended) noexcept {
+        auto t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        const auto b = bottom.load(memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        auto* r = current.load(memory_order_acquire);
+        void* ptr = r->get(t);
+        if (top.compare_exchange_strong(t, t + 1, memory_order_seq_cst,
+                                        memory_order_relaxed) == false) {
+            contended = true;
+            return nullptr;
+        }
+        return ptr;
+    }
+};
+
+struct thread_pool::worker final {
+    thread_pool* pool;
+    work_deque tasks{};
+    uint32_t seed; // for the random victim
+    thread th{};
+
+    worker(thread_pool* _pool, uint32_t _seed) noexcept(false)
+        : pool{_pool}, seed{_seed} {
+    }
+
+    /**
+     * @see xorshift32
+     */
+    uint32_t next_random() noexcept {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+};
+
+static thread_local thread_pool::worker* current_worker = nullptr;
+
+static void wake_all(atomic<uint32_t>& word) noexcept {
+    word.fetch_add(1, memory_order_seq_cst);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+            INT32_MAX, nullptr, nullptr, 0);
+}
+
+thread_pool::thread_pool(uint32_t count) noexcept(false) {
+    if (count == 0)
+        count = max(thread::hardware_concurrency(), 1u);
+    workers.reserve(count);
+    for (auto i = 0u; i < count; ++i)
+        workers.emplace_back(make_unique<worker>(this, 2 * i + 1));
+    // start after all deques are ready. the workers will steal from them
+    try {
+        for (auto& w : workers)
+            w->th = thread{[this, w = w.get()]() { run(*w); }};
+    } catch (const system_error&) {
+        stopped.store(true, memory_order_seq_cst);
+        wake_all(epoch);
+        for (auto& w : workers)
+            if (w->th.joinable())
+                w->th.join();
+        throw;
+    }
+}
+
+thread_pool::~thread_pool() noexcept {
+    stopped.store(true, memory_order_seq_cst);
+    wake_all(epoch);
+    for (auto& w : workers)
+        if (w->th.joinable())
+            w->th.join();
+}
+
+thread_pool& thread_pool::get_default() noexcept(false) {
+    static thread_pool pool{};
+    return pool;
+}
+
+void thread_pool::park(uint32_t expected) noexcept {
+    sleepers.fetch_add(1, memory_order_seq_cst);
+    // returns immediately if there was a submission after `expected`
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE,
+            expected, nullptr, nullptr, 0);
+    sleepers.fetch_sub(1, memory_order_seq_cst);
+}
+
+void thread_pool::wake_one() noexcept {
+    epoch.fetch_add(1, memory_order_seq_cst);
+    if (sleepers.load(memory_order_seq_cst) == 0)
+        return;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE,
+            1, nullptr, nullptr, 0);
+}
+
+void thread_pool::submit(coroutine_handle<void> coro) noexcept(false) {
+    if (current_worker && current_worker->pool == this) {
+        current_worker->tasks.push(coro.address());
+    } else {
+        unique_lock lck{mtx};
+        shared.push_back(coro.address());
+    }
+    return wake_one();
+}
+
+void* thread_pool::find_work(worker& w) noexcept {
+    if (void* ptr = w.tasks.take())
+        return ptr;
+    {
+        unique_lock lck{mtx};
+        if (shared.empty() == false) {
+            void* ptr = shared.front();
+            shared.pop_front();
+            return ptr;
+        }
+    }
+    // visit all the others from a random victim.
+    // retry while some of them was contended
+    const auto count = static_cast<uint32_t>(workers.size());
+    bool contended = true;
+    while (contended) {
+        contended = false;
+        const auto start = w.next_random();
+        for (auto i = 0u; i < count; ++i) {
+            auto& victim = *workers[(start + i) % count];
+            if (&victim == &w)
+                continue;
+            if (void* ptr = victim.tasks.steal(contended))
+                return ptr;
+        }
+    }
+    return nullptr;
+}
+
+void thread_pool::run(worker& w) noexcept(false) {
+    current_worker = &w;
+    while (true) {
+        // read before the search. `park` will fail if it changes meanwhile
+        const auto expected = epoch.load(memory_order_seq_cst);
+        if (void* ptr = find_work(w)) {
+            coroutine_handle<void>::from_address(ptr).resume();
+            continue;
+        }
+        if (stopped.load(memory_order_seq_cst))
+            break;
+        park(expected);
+    }
+    current_worker = nullptr;
+}
+
+} // namespace coro
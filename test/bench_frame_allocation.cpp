@@ -0,0 +1,151 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Count the frame allocations per coroutine call
+ *
+ * The global `operator new` is replaced to count the heap allocations.
+ * If the compiler elides the frame allocation (HALO), the count is 0.
+ * The test fails if a case allocates more than its expectation for the
+ * current compiler. See `get_expectation`.
+ *
+ * @see P0981R0 "Halo: coroutine Heap Allocation eLision Optimization"
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <coroutine/channel.hpp>
+#include <coroutine/return.h>
+#include <coroutine/yield.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+atomic<size_t> allocation_count{};
+
+void* operator new(size_t sz) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(sz))
+        return ptr;
+    throw bad_alloc{};
+}
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+auto yield_until(int n) -> enumerable<int> {
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+}
+
+auto suspend_once(int& value) -> frame_t {
+    co_await suspend_always{};
+    value += 1;
+}
+
+auto write_to(channel<int>& ch, int value) -> no_return_t {
+    co_await ch.write(value);
+}
+
+auto read_from(channel<int>& ch, int& value) -> no_return_t {
+    auto t = co_await ch.read();
+    value += get<0>(t);
+}
+
+// the frame doesn't escape from the caller
+int call_enumerable() {
+    int sum = 0;
+    for (auto v : yield_until(4))
+        sum += v;
+    return sum;
+}
+
+int call_frame_t() {
+    int value = 0;
+    auto frame = suspend_once(value);
+    frame.resume();
+    frame.destroy();
+    return value;
+}
+
+// the frames escape. they are suspended in the channel
+int call_channel() {
+    channel<int> ch{};
+    int value = 0;
+    write_to(ch, 1);
+    read_from(ch, value);
+    return value;
+}
+
+struct bench_case final {
+    const char* name;
+    int (*call)();
+    size_t expected; // upper bound of allocation per call
+};
+
+/**
+ * @brief Clang can elide the frame only when it sees the `resume`/`destroy`.
+ *        So it is expected with `USE_INLINE_COROUTINE_HANDLE` in optimized
+ *        build. GCC and MSVC don't perform the elision.
+ *
+ * Only `bench_frame_allocation_inline` built by Clang checks the elision.
+ * It is always built with -O2. Clang 14 gives 0 alloc/call for the
+ * `enumerable` and `frame_t` cases, and 1 without the inline handle.
+ */
+#if defined(__clang__) && defined(USE_INLINE_COROUTINE_HANDLE) &&             \
+    defined(__OPTIMIZE__)
+constexpr bool compiler_elides_frame = true;
+#else
+constexpr bool compiler_elides_frame = false;
+#endif
+
+/**
+ * @brief Allocations per call that the current compiler must not exceed
+ * @param elidable the frame doesn't escape from the caller
+ */
+constexpr size_t get_expectation(bool elidable) noexcept {
+    return (elidable && compiler_elides_frame) ? 0 : 1;
+}
+
+int main(int, char*[]) {
+    constexpr auto repeat = 1'000'000;
+    const bench_case cases[] = {
+        {"enumerable", call_enumerable, get_expectation(true)},
+        {"frame_t", call_frame_t, get_expectation(true)},
+        {"channel", call_channel, 2 * get_expectation(false)},
+    };
+
+    int failed = 0;
+    for (const auto& c : cases) {
+        int checksum = 0;
+        const auto count = allocation_count.load();
+        const auto start = steady_clock::now();
+        for (auto i = 0; i < repeat; ++i)
+            checksum += c.call();
+        const auto elapsed =
+            duration_cast<nanoseconds>(steady_clock::now() - start);
+        const auto allocated = allocation_count.load() - count;
+
+        const auto per_call = static_cast<double>(allocated) / repeat;
+        printf("%-12s %.3f alloc/call (expect <= %zu), %.3f ns/call, %d\n",
+               c.name, per_call, c.expected,
+               static_cast<double>(elapsed.count()) / repeat, checksum);
+        if (allocated > c.expected * repeat) {
+            fprintf(stderr, "%s: frame allocation elision regressed\n",
+                    c.name);
+            ++failed;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,81 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Measure the cost of `coroutine_handle<void>::resume`
+ *
+ * The same source is built 3 times. (see CMakeLists.txt)
+ *   - bench_frame_resume: `portable_coro_resume` in `coroutine_portable`
+ *   - bench_frame_resume_inline: `USE_INLINE_COROUTINE_HANDLE`
+ *   - bench_frame_resume_native: `<coroutine>` of the compiler
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(USE_NATIVE_COROUTINE_HEADER)
+#if __has_include(<coroutine>) && !defined(__clang__)
+#include <coroutine>
+namespace co = std;
+#else
+#include <experimental/coroutine>
+namespace co = std::experimental;
+#endif
+static constexpr auto variant = "native";
+#else
+#include <coroutine/frame.h>
+namespace co = std;
+#if defined(USE_INLINE_COROUTINE_HANDLE)
+static constexpr auto variant = "inline";
+#else
+static constexpr auto variant = "portable";
+#endif
+#endif
+
+using namespace std::chrono;
+
+struct resumable_t final {
+    struct promise_type final {
+        co::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        co::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void unhandled_exception() noexcept(false) {
+            throw;
+        }
+        void return_void() noexcept {
+        }
+        resumable_t get_return_object() noexcept {
+            return {co::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+    co::coroutine_handle<promise_type> coro;
+};
+
+// suspend until the counter reaches zero
+auto count_down(uint64_t& counter) -> resumable_t {
+    while (counter--)
+        co_await co::suspend_always{};
+}
+
+int main(int, char*[]) {
+    constexpr uint64_t repeat = 1 << 24;
+
+    uint64_t counter = repeat;
+    auto task = count_down(counter).coro;
+
+    const auto start = steady_clock::now();
+    while (task.done() == false)
+        task.resume();
+    const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+    task.destroy();
+
+    if (counter != UINT64_MAX) // the loop must consume all counts
+        return __LINE__;
+
+    printf("%s: %llu resume in %lld ns (%.3f ns/resume)\n", variant,
+           static_cast<unsigned long long>(repeat),
+           static_cast<long long>(elapsed.count()),
+           static_cast<double>(elapsed.count()) / repeat);
+    return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Round trip throughput of the echo for each `io_backend`
+ *
+ * For each backend, UDP and TCP(loopback) pairs exchange small messages.
+ * The result is printed in round trips per second.
+ */
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+#include <socket.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+using io_buffer_reserved_t = array<std::byte, 64>;
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr uint32_t pair_count = 8;
+constexpr uint32_t round_trip_count = 20'000;
+
+auto udp_echo(int64_t sd, uint32_t count, uint32_t& running) -> no_return_t {
+    io_work_t work{};
+    sockaddr_in remote{};
+    io_buffer_reserved_t storage{};
+    while (count--) {
+        auto len = co_await recv_from(sd, remote, storage, work);
+        if (work.error())
+            break;
+        co_await send_to(sd, remote,
+                         {storage.data(), gsl::narrow_cast<ptrdiff_t>(len)},
+                         work);
+        if (work.error())
+            break;
+    }
+    --running;
+}
+
+auto udp_ping(int64_t sd, const sockaddr_in& remote, uint32_t count,
+              uint32_t& running) -> no_return_t {
+    io_work_t work{};
+    sockaddr_in peer{};
+    io_buffer_reserved_t storage{};
+    while (count--) {
+        co_await send_to(sd, remote, storage, work);
+        if (work.error())
+            break;
+        co_await recv_from(sd, peer, storage, work);
+        if (work.error())
+            break;
+    }
+    --running;
+}
+
+auto tcp_echo(int64_t sd, uint32_t count, uint32_t& running) -> no_return_t {
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    while (count--) {
+        auto len = co_await recv_stream(sd, storage, 0, work);
+        if (len <= 0)
+            break;
+        co_await send_stream(
+            sd, {storage.data(), gsl::narrow_cast<ptrdiff_t>(len)}, 0, work);
+        if (work.error())
+            break;
+    }
+    --running;
+}
+
+auto tcp_ping(int64_t sd, uint32_t count, uint32_t& running) -> no_return_t {
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    while (count--) {
+        co_await send_stream(sd, storage, 0, work);
+        if (work.error())
+            break;
+        // the message can be split
+        size_t received = 0;
+        while (received < storage.size()) {
+            auto len = co_await recv_stream(
+                sd,
+                {storage.data() + received,
+                 gsl::narrow_cast<ptrdiff_t>(storage.size() - received)},
+                0, work);
+            if (len <= 0)
+                goto OnError;
+            received += static_cast<size_t>(len);
+        }
+    }
+OnError:
+    --running;
+}
+
+void run_until_return(uint32_t& running) {
+    while (running)
+        poll_net_tasks(1'000'000);
+}
+
+void report(const char* name, io_backend backend,
+            steady_clock::time_point start) {
+    const auto elapsed =
+        duration_cast<duration<double>>(steady_clock::now() - start);
+    const auto total = static_cast<double>(pair_count) * round_trip_count;
+    printf("%-4s %-9s %10.0f round-trip/s\n", name,
+           backend == io_backend::epoll ? "epoll" : "io_uring",
+           total / elapsed.count());
+}
+
+void bench_udp(io_backend backend) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    hint.ai_socktype = SOCK_DGRAM;
+    hint.ai_protocol = IPPROTO_UDP;
+
+    array<int64_t, 2 * pair_count> sockets{};
+    array<sockaddr_in, 2 * pair_count> addrs{};
+    for (auto i = 0u; i < sockets.size(); ++i) {
+        auto& sd = sockets[i];
+        if (socket_create(hint, sd))
+            exit(__LINE__);
+        auto& local = addrs[i];
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socket_bind(sd, local);
+        socklen_t len = sizeof(local);
+        getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+        socket_set_option_nonblock(sd);
+    }
+
+    uint32_t running = 2 * pair_count;
+    const auto start = steady_clock::now();
+    for (auto i = 0u; i < pair_count; ++i) {
+        udp_echo(sockets[2 * i], round_trip_count, running);
+        udp_ping(sockets[2 * i + 1], addrs[2 * i], round_trip_count, running);
+    }
+    run_until_return(running);
+    report("udp", backend, start);
+
+    for (auto sd : sockets) {
+        unregister_socket(sd); // the descriptors are reused in the next run
+        socket_close(sd);
+    }
+}
+
+void bench_tcp(io_backend backend) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    hint.ai_socktype = SOCK_STREAM;
+    hint.ai_protocol = IPPROTO_TCP;
+
+    int64_t ln{};
+    if (socket_create(hint, ln))
+        exit(__LINE__);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socket_bind(ln, local);
+    socklen_t len = sizeof(local);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+    socket_listen(ln, pair_count);
+
+    array<int64_t, 2 * pair_count> sockets{};
+    for (auto i = 0u; i < pair_count; ++i) {
+        auto& client = sockets[2 * i + 1];
+        if (socket_create(hint, client))
+            exit(__LINE__);
+        if (socket_connect(client, local))
+            exit(__LINE__);
+        if (socket_accept(ln, sockets[2 * i]))
+            exit(__LINE__);
+    }
+    for (auto sd : sockets) {
+        socket_set_option_nonblock(sd);
+        socket_set_option_nodelay(sd);
+    }
+
+    uint32_t running = 2 * pair_count;
+    const auto start = steady_clock::now();
+    for (auto i = 0u; i < pair_count; ++i) {
+        tcp_echo(sockets[2 * i], round_trip_count, running);
+        tcp_ping(sockets[2 * i + 1], round_trip_count, running);
+    }
+    run_until_return(running);
+    report("tcp", backend, start);
+
+    for (auto sd : sockets) {
+        unregister_socket(sd); // the descriptors are reused in the next run
+        socket_close(sd);
+    }
+    socket_close(ln);
+}
+
+int main(int, char*[]) {
+    socket_setup();
+    auto on_return = gsl::finally([]() { socket_teardown(); });
+
+    for (auto backend : {io_backend::epoll, io_backend::io_uring}) {
+        if (select_io_backend(backend) == false) {
+            fprintf(stderr, "io_backend %u is not supported\n",
+                    static_cast<uint32_t>(backend));
+            continue;
+        }
+        bench_udp(backend);
+        bench_tcp(backend);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Datagrams per second of `recv_batch`/`send_batch` and
+ *         `recv_from`/`send_to` for each `io_backend`
+ *
+ * The ping sends a window of datagrams, and the echo returns all of them.
+ * The result is printed in datagrams(both directions) per second.
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+#include <socket.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr uint32_t pair_count = 4;
+constexpr uint32_t window = 32;
+constexpr uint32_t round_count = 1'000;
+
+using datagram_t = array<uint32_t, 16>; // [0] is the sequence
+
+io_buffer_t as_buffer(datagram_t& dgram) {
+    return {reinterpret_cast<std::byte*>(dgram.data()), sizeof(datagram_t)};
+}
+
+/**
+ * @brief `mmsghdr` slots with their own buffer and address
+ */
+struct batch_t final {
+    array<mmsghdr, window> msgs{};
+    array<iovec, window> iovs{};
+    array<sockaddr_in, window> addrs{};
+    array<datagram_t, window> dgrams{};
+
+    void prepare() noexcept {
+        for (auto i = 0u; i < window; ++i) {
+            iovs[i].iov_base = dgrams[i].data();
+            iovs[i].iov_len = sizeof(datagram_t);
+            auto& hdr = msgs[i].msg_hdr;
+            hdr = {};
+            hdr.msg_name = &addrs[i];
+            hdr.msg_namelen = sizeof(sockaddr_in);
+            hdr.msg_iov = &iovs[i];
+            hdr.msg_iovlen = 1;
+            msgs[i].msg_len = 0;
+        }
+    }
+};
+
+auto single_echo(int64_t sd, uint32_t count, uint32_t& running)
+    -> no_return_t {
+    io_work_t work{};
+    sockaddr_in remote{};
+    datagram_t dgram{};
+    while (count--) {
+        auto len = co_await recv_from(sd, remote, as_buffer(dgram), work);
+        if (work.error())
+            break;
+        co_await send_to(sd, remote, as_buffer(dgram).first(len), work);
+        if (work.error())
+            break;
+    }
+    --running;
+}
+
+auto single_ping(int64_t sd, const sockaddr_in& remote, uint32_t& running)
+    -> no_return_t {
+    io_work_t work{};
+    sockaddr_in peer{};
+    datagram_t dgram{};
+    for (auto r = 0u; r < round_count; ++r) {
+        for (auto i = 0u; i < window; ++i) {
+            dgram[0] = i;
+            co_await send_to(sd, remote, as_buffer(dgram), work);
+            if (work.error())
+                goto OnError;
+        }
+        for (auto i = 0u; i < window; ++i) {
+            co_await recv_from(sd, peer, as_buffer(dgram), work);
+            if (work.error())
+                goto OnError;
+            assert(dgram[0] == i);
+        }
+    }
+OnError:
+    --running;
+}
+
+auto batch_echo(int64_t sd, uint32_t count, uint32_t& running)
+    -> no_return_t {
+    io_work_t work{};
+    batch_t batch{};
+    while (count) {
+        batch.prepare();
+        auto received = co_await recv_batch(sd, batch.msgs, 0, work);
+        if (received <= 0)
+            break;
+        // return them to where they came from
+        for (auto i = 0; i < received; ++i)
+            batch.iovs[i].iov_len = batch.msgs[i].msg_len;
+        uint32_t sent = 0;
+        while (sent < received) {
+            gsl::span<mmsghdr> msgs{batch.msgs.data() + sent,
+                                    static_cast<ptrdiff_t>(received - sent)};
+            auto n = co_await send_batch(sd, msgs, 0, work);
+            if (n <= 0)
+                goto OnError;
+            sent += static_cast<uint32_t>(n);
+        }
+        count -= static_cast<uint32_t>(received);
+    }
+OnError:
+    --running;
+}
+
+auto batch_ping(int64_t sd, const sockaddr_in& remote, uint32_t& running)
+    -> no_return_t {
+    io_work_t work{};
+    batch_t batch{};
+    for (auto r = 0u; r < round_count; ++r) {
+        batch.prepare();
+        for (auto i = 0u; i < window; ++i) {
+            batch.addrs[i] = remote;
+            batch.dgrams[i][0] = i;
+        }
+        uint32_t sent = 0;
+        while (sent < window) {
+            gsl::span<mmsghdr> msgs{batch.msgs.data() + sent,
+                                    static_cast<ptrdiff_t>(window - sent)};
+            auto n = co_await send_batch(sd, msgs, 0, work);
+            if (n <= 0)
+                goto OnError;
+            sent += static_cast<uint32_t>(n);
+        }
+        uint32_t received = 0;
+        while (received < window) {
+            batch.prepare();
+            gsl::span<mmsghdr> msgs{batch.msgs.data(),
+                                    static_cast<ptrdiff_t>(window - received)};
+            auto n = co_await recv_batch(sd, msgs, 0, work);
+            if (n <= 0)
+                goto OnError;
+            for (auto i = 0; i < n; ++i)
+                assert(batch.dgrams[i][0] == received + i);
+            received += static_cast<uint32_t>(n);
+        }
+    }
+OnError:
+    --running;
+}
+
+void run_until_return(uint32_t& running) {
+    while (running)
+        poll_net_tasks(1'000'000);
+}
+
+void report(const char* name, io_backend backend,
+            steady_clock::time_point start) {
+    const auto elapsed =
+        duration_cast<duration<double>>(steady_clock::now() - start);
+    const auto total =
+        2.0 * pair_count * round_count * window; // both directions
+    printf("%-6s %-9s %10.0f datagram/s\n", name,
+           backend == io_backend::epoll ? "epoll" : "io_uring",
+           total / elapsed.count());
+}
+
+void bench_udp(io_backend backend, bool batch) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    hint.ai_socktype = SOCK_DGRAM;
+    hint.ai_protocol = IPPROTO_UDP;
+
+    array<int64_t, 2 * pair_count> sockets{};
+    array<sockaddr_in, 2 * pair_count> addrs{};
+    for (auto i = 0u; i < sockets.size(); ++i) {
+        auto& sd = sockets[i];
+        if (socket_create(hint, sd))
+            exit(__LINE__);
+        auto& local = addrs[i];
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socket_bind(sd, local);
+        socklen_t len = sizeof(local);
+        getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+        socket_set_option_nonblock(sd);
+    }
+
+    uint32_t running = 2 * pair_count;
+    const auto start = steady_clock::now();
+    for (auto i = 0u; i < pair_count; ++i) {
+        const auto count = round_count * window;
+        if (batch) {
+            batch_echo(sockets[2 * i], count, running);
+            batch_ping(sockets[2 * i + 1], addrs[2 * i], running);
+        } else {
+            single_echo(sockets[2 * i], count, running);
+            single_ping(sockets[2 * i + 1], addrs[2 * i], running);
+        }
+    }
+    run_until_return(running);
+    report(batch ? "batch" : "single", backend, start);
+
+    for (auto sd : sockets) {
+        unregister_socket(sd); // the descriptors are reused in the next run
+        socket_close(sd);
+    }
+}
+
+int main(int, char*[]) {
+    socket_setup();
+    auto on_return = gsl::finally([]() { socket_teardown(); });
+
+    for (auto backend : {io_backend::epoll, io_backend::io_uring}) {
+        if (select_io_backend(backend) == false) {
+            fprintf(stderr, "io_backend %u is not supported\n",
+                    static_cast<uint32_t>(backend));
+            continue;
+        }
+        bench_udp(backend, false);
+        bench_udp(backend, true);
+    }
+    return EXIT_SUCCESS;
+}
@@ -9,7 +9,11 @@
 #include <coroutine/channel.hpp>
 #include <coroutine/return.h>
 
+#if defined(_WIN32)
 #include <coroutine/windows.h>
+#elif defined(__linux__)
+#include <coroutine/linux.h>
+#endif
 #include <latch.h>
 
 using namespace std;
@@ -0,0 +1,74 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <cstring>
+
+#include <coroutine/frame_stat.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+// `frame_t` with allocation hook
+class measured_frame_t : public coroutine_handle<void> {
+  public:
+    class promise_type : public promise_na,
+                         public frame_stat_promise<measured_frame_t> {
+      public:
+        void unhandled_exception() noexcept(false) {
+            throw;
+        }
+        void return_void() noexcept {
+        }
+        measured_frame_t get_return_object() noexcept {
+            return measured_frame_t{
+                coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+    explicit measured_frame_t(coroutine_handle<void> frame) noexcept
+        : coroutine_handle<void>{frame} {
+    }
+};
+
+// the buffer must be placed in the frame since it lives across the suspension
+auto hold_buffer(size_t& used) -> measured_frame_t {
+    array<std::byte, 3900> storage{};
+    co_await suspend_always{};
+    used = storage.size();
+}
+
+int main(int, char*[]) {
+    auto& stat = frame_stat_promise<measured_frame_t>::get_frame_stat();
+    assert(stat.live_count == 0);
+
+    size_t used = 0;
+    auto f1 = hold_buffer(used);
+    auto f2 = hold_buffer(used);
+    assert(stat.live_count == 2);
+    assert(stat.total_count == 2);
+    assert(stat.frame_size >= 3900);
+    assert(stat.max_frame_size == stat.frame_size);
+    assert(stat.live_bytes == 2 * stat.frame_size);
+
+    f1.resume();
+    f1.destroy();
+    assert(stat.live_count == 1);
+    assert(stat.live_bytes == stat.frame_size);
+    f2.resume();
+    f2.destroy();
+    assert(stat.live_count == 0);
+    assert(stat.live_bytes == 0);
+    assert(used == 3900);
+
+    // the statistics can be found in the list
+    bool found = false;
+    for (auto* s = frame_stat_list(); s; s = s->next)
+        if (s == &stat)
+            found = true;
+    assert(found);
+    assert(strlen(stat.name) > 0);
+    return 0;
+}
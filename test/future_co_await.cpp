@@ -0,0 +1,53 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <cassert>
+
+#include <coroutine/future.hpp>
+
+using namespace std;
+using namespace coro;
+
+auto wait_for_resume(coroutine_handle<void>& handle) -> frame_future<int> {
+    struct awaiter final : suspend_always {
+        coroutine_handle<void>& handle;
+        void await_suspend(coroutine_handle<void> coro) noexcept {
+            handle = coro;
+        }
+    };
+    co_await awaiter{{}, handle};
+    co_return 7;
+}
+
+auto twice(frame_future<int>& f) -> frame_future<int> {
+    const auto value = co_await f;
+    co_return 2 * value;
+}
+
+auto return_now(int value) -> frame_future<int> {
+    co_return value;
+}
+
+int main(int, char*[]) {
+    coroutine_handle<void> handle{};
+    auto f1 = wait_for_resume(handle);
+    auto f2 = twice(f1);
+    // both are suspended
+    assert(f1.is_ready() == false);
+    assert(f2.is_ready() == false);
+
+    // `f1` returns and resumes `f2` in this thread
+    handle.resume();
+    assert(f1.is_ready());
+    assert(f2.is_ready());
+    assert(f2.get() == 14);
+
+    // `co_await` for the completed one doesn't suspend
+    auto f3 = return_now(4);
+    assert(f3.is_ready());
+    auto f4 = twice(f3);
+    assert(f4.is_ready());
+    assert(f4.get() == 8);
+    return EXIT_SUCCESS;
+}
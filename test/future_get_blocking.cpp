@@ -0,0 +1,48 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+
+#include <coroutine/future.hpp>
+
+using namespace std;
+using namespace coro;
+
+// resume the coroutine in a new thread
+struct continue_on_new_thread final : suspend_always {
+    void await_suspend(coroutine_handle<void> coro) noexcept(false) {
+        thread{[coro]() { coro.resume(); }}.detach();
+    }
+};
+
+auto add_in_other_thread(int lhs, int rhs, thread::id& tid)
+    -> frame_future<int> {
+    co_await continue_on_new_thread{};
+    tid = this_thread::get_id();
+    co_return lhs + rhs;
+}
+
+auto throw_in_other_thread() -> frame_future<void> {
+    co_await continue_on_new_thread{};
+    throw runtime_error{"frame_future"};
+}
+
+int main(int, char*[]) {
+    thread::id tid{};
+    auto f1 = add_in_other_thread(1, 2, tid);
+    // blocks until the other thread `co_return`
+    assert(f1.get() == 3);
+    assert(f1.is_ready());
+    assert(tid != this_thread::get_id());
+
+    auto f2 = throw_in_other_thread();
+    try {
+        f2.get();
+        return __LINE__;
+    } catch (const runtime_error&) {
+    }
+    return EXIT_SUCCESS;
+}
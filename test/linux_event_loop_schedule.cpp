@@ -0,0 +1,54 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+#include <coroutine/linux.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+auto hop_between(event_loop& loop1, event_loop& loop2, //
+                 thread::id& tid1, thread::id& tid2,
+                 atomic_uint32_t& counter) -> null_frame_t {
+    co_await loop1.schedule();
+    assert(event_loop::current() == &loop1);
+    tid1 = this_thread::get_id();
+
+    co_await loop2.schedule();
+    assert(event_loop::current() == &loop2);
+    tid2 = this_thread::get_id();
+    counter += 1;
+}
+
+int main(int, char*[]) {
+    event_loop loop1{}, loop2{};
+    thread worker1{[&loop1]() { loop1.run(); }};
+    thread worker2{[&loop2]() { loop2.run(); }};
+
+    constexpr auto num_task = 1000u;
+    atomic_uint32_t counter{};
+    thread::id tid1{}, tid2{};
+    for (auto i = 0u; i < num_task; ++i)
+        hop_between(loop1, loop2, tid1, tid2, counter);
+
+    auto repeat = 1000;
+    while (counter < num_task && repeat--)
+        this_thread::sleep_for(10ms);
+
+    const auto id1 = worker1.get_id(), id2 = worker2.get_id();
+    loop1.stop();
+    loop2.stop();
+    worker1.join();
+    worker2.join();
+
+    assert(counter == num_task);
+    // the last coroutine was resumed in the workers
+    assert(tid1 == id1);
+    assert(tid2 == id2);
+    return EXIT_SUCCESS;
+}
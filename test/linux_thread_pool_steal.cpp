@@ -0,0 +1,56 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <coroutine/linux.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+struct fan_out_context final {
+    atomic<uint32_t> done{};
+    mutex mtx{};
+    set<thread::id> threads{};
+};
+
+auto child(thread_pool& pool, fan_out_context& ctx) -> null_frame_t {
+    co_await continue_on_thread_pool{pool};
+    this_thread::sleep_for(chrono::microseconds{100});
+    {
+        unique_lock lck{ctx.mtx};
+        ctx.threads.emplace(this_thread::get_id());
+    }
+    ctx.done.fetch_add(1);
+}
+
+// spawn the children in a worker. they are pushed to its own deque,
+// so the other workers must steal them
+auto parent(thread_pool& pool, fan_out_context& ctx, uint32_t count)
+    -> null_frame_t {
+    co_await continue_on_thread_pool{pool};
+    for (auto i = 0u; i < count; ++i)
+        child(pool, ctx);
+}
+
+int main(int, char*[]) {
+    constexpr uint32_t count = 2000;
+    thread_pool pool{4};
+    assert(pool.size() == 4);
+
+    fan_out_context ctx{};
+    parent(pool, ctx, count);
+    while (ctx.done.load() != count)
+        this_thread::sleep_for(chrono::milliseconds{1});
+
+    unique_lock lck{ctx.mtx};
+    assert(ctx.threads.count(this_thread::get_id()) == 0);
+    assert(ctx.threads.size() > 1);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Each thread serves its own connections with its own reactor
+ */
+#undef NDEBUG
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+#include <socket.hpp>
+
+using namespace std;
+using namespace coro;
+
+using io_buffer_reserved_t = array<std::byte, 64>;
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr auto connection_count = 16u;
+atomic<uint32_t> served{};
+atomic<uint32_t> wrong_thread{};
+
+auto echo_service(int64_t sd) -> no_return_t {
+    const auto owner = this_thread::get_id();
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    while (true) {
+        auto len = co_await recv_stream(sd, storage, 0, work);
+        if (this_thread::get_id() != owner)
+            wrong_thread.fetch_add(1);
+        if (len <= 0)
+            break;
+        io_buffer_t buf{storage.data(), gsl::narrow_cast<ptrdiff_t>(len)};
+        co_await send_stream(sd, buf, 0, work);
+        if (work.error())
+            break;
+    }
+    unregister_socket(sd);
+    socket_close(sd);
+    served.fetch_add(1);
+}
+
+// accept and serve until all connections are closed
+void serve(int64_t ln) {
+    while (served.load() < connection_count) {
+        int64_t cs = -1;
+        while (socket_accept(ln, cs) == 0) {
+            socket_set_option_nonblock(cs);
+            echo_service(cs);
+        }
+        poll_net_tasks(1'000'000); // 1 ms
+    }
+    socket_close(ln);
+}
+
+void test_reuseport_listeners() {
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = 0; // let the system decide the port
+
+    const auto ln1 = listen_reuseport(local, 16);
+    socklen_t len = sizeof(local);
+    getsockname(ln1, reinterpret_cast<sockaddr*>(&local), &len);
+    // the same address for the other thread
+    const auto ln2 = listen_reuseport(local, 16);
+
+    thread t1{serve, ln1}, t2{serve, ln2};
+    for (auto i = 0u; i < connection_count; ++i) {
+        addrinfo hint{};
+        hint.ai_family = AF_INET;
+        hint.ai_socktype = SOCK_STREAM;
+        hint.ai_protocol = IPPROTO_TCP;
+        int64_t sd{};
+        if (socket_create(hint, sd) || socket_connect(sd, local))
+            exit(__LINE__);
+        const char message[] = "reactor";
+        char echo[sizeof(message)]{};
+        assert(send(sd, message, sizeof(message), 0) == sizeof(message));
+        assert(recv(sd, echo, sizeof(echo), MSG_WAITALL) == sizeof(echo));
+        assert(string_view{echo} == message);
+        socket_close(sd);
+    }
+    t1.join();
+    t2.join();
+    assert(served.load() == connection_count);
+    assert(wrong_thread.load() == 0);
+}
+
+auto recv_once(int64_t sd, thread::id& resumed, bool& done) -> no_return_t {
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    auto len = co_await recv_stream(sd, storage, 0, work);
+    assert(len > 0);
+    resumed = this_thread::get_id();
+    done = true;
+}
+
+void test_migration() {
+    int sv[2]{};
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const char message[] = "migrate";
+
+    // bound to the reactor of this thread
+    thread::id resumed{};
+    bool done = false;
+    recv_once(sv[0], resumed, done);
+    assert(done == false);
+    // the coroutine is waiting. it can't be moved
+    thread{[sd = sv[0]]() {
+        try {
+            migrate_socket(sd);
+            exit(__LINE__);
+        } catch (const system_error& e) {
+            assert(e.code().value() == EBUSY);
+        }
+    }}.join();
+    assert(write(sv[1], message, sizeof(message)) == sizeof(message));
+    while (done == false)
+        poll_net_tasks(1'000'000);
+    assert(resumed == this_thread::get_id());
+
+    // move to the other thread. then only it can resume the coroutine
+    thread::id worker{};
+    done = false;
+    thread t{[sd = sv[0], &worker, &resumed, &done]() {
+        worker = this_thread::get_id();
+        migrate_socket(sd);
+        recv_once(sd, resumed, done);
+        while (done == false)
+            poll_net_tasks(1'000'000);
+        unregister_socket(sd); // before the reactor is destroyed
+    }};
+    // poll of this thread doesn't resume the coroutine
+    for (auto i = 0; i < 10; ++i)
+        poll_net_tasks(1'000'000);
+    assert(write(sv[1], message, sizeof(message)) == sizeof(message));
+    t.join();
+    assert(resumed == worker);
+
+    close(sv[0]);
+    close(sv[1]);
+}
+
+int main(int, char*[]) {
+    socket_setup();
+    test_reuseport_listeners();
+    test_migration();
+    socket_teardown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Async `get_address`/`get_name` with the stub DNS server on loopback
+ *
+ * The stub server runs in the same thread. If the resolution blocked the
+ * loop, nothing would be answered.
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+using message_t = array<uint8_t, 512>;
+
+/**
+ * @brief Read the question of the query
+ * @return size_t the end of the question
+ */
+size_t read_question(const message_t& query, string& name, uint16_t& type) {
+    size_t pos = 12;
+    name.clear();
+    while (query[pos]) {
+        if (name.empty() == false)
+            name += '.';
+        name.append(reinterpret_cast<const char*>(&query[pos + 1]),
+                    query[pos]);
+        pos += 1 + query[pos];
+    }
+    type = static_cast<uint16_t>(query[pos + 1] << 8 | query[pos + 2]);
+    return pos + 5;
+}
+
+/**
+ * @brief Append the record for the name of the question(compressed)
+ */
+size_t append_record(message_t& answer, size_t pos, uint16_t type,
+                     const void* data, uint16_t length) {
+    const uint8_t fixed[] = {
+        0xC0, 12,        // name: pointer to the question
+        0,    0,         // type
+        0,    1,         // class: IN
+        0,    0, 1, 44,  // ttl: 300
+        0,    0,         // rdlength
+    };
+    memcpy(&answer[pos], fixed, sizeof(fixed));
+    answer[pos + 2] = type >> 8;
+    answer[pos + 3] = type & 0xFF;
+    answer[pos + 10] = length >> 8;
+    answer[pos + 11] = length & 0xFF;
+    memcpy(&answer[pos + 12], data, length);
+    return pos + 12 + length;
+}
+
+/**
+ * @return size_t the length of the answer. 0 for no answer
+ */
+size_t make_answer(const message_t& query, message_t& answer,
+                   uint32_t& retry_count) {
+    string name{};
+    uint16_t type = 0;
+    auto pos = read_question(query, name, type);
+    memcpy(answer.data(), query.data(), pos);
+    answer[2] = 0x81; // response, recursion desired
+    answer[3] = 0x80; // recursion available
+    uint16_t count = 0;
+    if (name == "stub.test" && type == 1) {
+        // CNAME first. the client must skip it
+        const uint8_t alias[] = {0xC0, 12};
+        pos = append_record(answer, pos, 5, alias, sizeof(alias));
+        const uint8_t a1[] = {127, 0, 0, 1}, a2[] = {127, 0, 0, 2};
+        pos = append_record(answer, pos, 1, a1, 4);
+        pos = append_record(answer, pos, 1, a2, 4);
+        count = 3;
+    } else if (name == "stub.test" && type == 28) {
+        pos = append_record(answer, pos, 28, &in6addr_loopback, 16);
+        count = 1;
+    } else if (name == "retry.test") {
+        if (retry_count++ == 0)
+            return 0; // dropped. the client must send again
+        const uint8_t a[] = {127, 0, 0, 3};
+        pos = append_record(answer, pos, 1, a, 4);
+        count = 1;
+    } else if (name == "1.0.0.127.in-addr.arpa" && type == 12) {
+        const uint8_t host[] = "\x04stub\x04test";
+        pos = append_record(answer, pos, 12, host, sizeof(host));
+        count = 1;
+    } else if (name == "silent.test") {
+        return 0;
+    } else {
+        answer[3] |= 3; // no such name
+    }
+    answer[6] = 0;
+    answer[7] = static_cast<uint8_t>(count);
+    return pos;
+}
+
+auto serve_stub(int64_t sd, io_cancel_token& token, uint32_t& retry_count,
+                bool& done) -> no_return_t {
+    io_work_t work{};
+    message_t query{}, answer{};
+    const auto forever = steady_clock::now() + hours{1};
+    while (true) {
+        sockaddr_in remote{};
+        io_buffer_t buf{reinterpret_cast<std::byte*>(query.data()),
+                        query.size()};
+        co_await recv_from(sd, remote, buf, work, forever, &token);
+        if (work.error())
+            break;
+        if (const auto len = make_answer(query, answer, retry_count)) {
+            io_buffer_t reply{reinterpret_cast<std::byte*>(answer.data()),
+                              static_cast<ptrdiff_t>(len)};
+            co_await send_to(sd, remote, reply, work);
+        }
+    }
+    done = true;
+}
+
+uint32_t wait(frame_future<uint32_t>& f) {
+    for (auto i = 0; i < 1000 && f.is_ready() == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(f.is_ready());
+    return f.get();
+}
+
+auto resolve_in_coroutine(const dns_config& config, sockaddr_in& output,
+                          uint32_t& errc) -> no_return_t {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    errc = co_await get_address(config, hint, "retry.test", "8080",
+                                gsl::span<sockaddr_in>{&output, 1});
+}
+
+void test_address(const dns_config& config) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    array<sockaddr_in, 4> storage{};
+    gsl::span<sockaddr_in> output{storage};
+    auto f = get_address(config, hint, "stub.test", "80", output);
+    assert(wait(f) == 0);
+    assert(output[0].sin_family == AF_INET);
+    assert(output[0].sin_addr.s_addr == htonl(0x7F000001));
+    assert(output[0].sin_port == htons(80));
+    assert(output[1].sin_addr.s_addr == htonl(0x7F000002));
+    assert(output[2].sin_family == 0); // not changed
+
+    hint.ai_family = AF_INET6;
+    array<sockaddr_in6, 2> storage6{};
+    gsl::span<sockaddr_in6> output6{storage6};
+    auto f6 = get_address(config, hint, "stub.test", nullptr, output6);
+    assert(wait(f6) == 0);
+    assert(memcmp(&output6[0].sin6_addr, &in6addr_loopback, 16) == 0);
+
+    hint.ai_family = AF_INET;
+    auto missing = get_address(config, hint, "missing.test", "80", output);
+    assert(wait(missing) == EAI_NONAME);
+
+    // numeric host doesn't need the query
+    auto numeric = get_address(config, hint, "10.1.2.3", "443", output);
+    assert(numeric.is_ready());
+    assert(numeric.get() == 0);
+    assert(output[0].sin_addr.s_addr == htonl(0x0A010203));
+    auto service = get_address(config, hint, "stub.test", "http", output);
+    assert(service.get() == EAI_SERVICE);
+}
+
+void test_retry(const dns_config& config, uint32_t& retry_count) {
+    sockaddr_in output{};
+    uint32_t errc = UINT32_MAX;
+    resolve_in_coroutine(config, output, errc);
+    for (auto i = 0; i < 1000 && errc == UINT32_MAX; ++i)
+        poll_net_tasks(10'000'000);
+    assert(errc == 0);
+    assert(retry_count == 2);
+    assert(output.sin_addr.s_addr == htonl(0x7F000003));
+    assert(output.sin_port == htons(8080));
+
+    addrinfo hint{};
+    sockaddr_in unused[1]{};
+    const auto start = steady_clock::now();
+    auto silent = get_address(config, hint, "silent.test", nullptr,
+                              gsl::span<sockaddr_in>{unused});
+    assert(wait(silent) == EAI_AGAIN);
+    assert(steady_clock::now() - start >= config.timeout * config.attempts);
+}
+
+void test_name(const dns_config& config) {
+    auto name = make_unique<char[]>(NI_MAXHOST);
+    auto serv = make_unique<char[]>(NI_MAXSERV);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(0x7F000001);
+    addr.sin_port = htons(7654);
+    auto f = get_name(config, addr, name.get(), serv.get());
+    assert(wait(f) == 0);
+    assert(strcmp(name.get(), "stub.test") == 0);
+    assert(strcmp(serv.get(), "7654") == 0);
+
+    // no record. numeric host unless `NI_NAMEREQD`
+    addr.sin_addr.s_addr = htonl(0x7F000009);
+    auto numeric = get_name(config, addr, name.get(), nullptr);
+    assert(wait(numeric) == 0);
+    assert(strcmp(name.get(), "127.0.0.9") == 0);
+    auto required = get_name(config, addr, name.get(), nullptr, NI_NAMEREQD);
+    assert(wait(required) == EAI_NONAME);
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    const auto sd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(local);
+    assert(bind(sd, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+
+    io_cancel_token token{};
+    uint32_t retry_count = 0;
+    bool done = false;
+    serve_stub(sd, token, retry_count, done);
+
+    dns_config config{};
+    config.server = local;
+    config.timeout = 100ms;
+    config.attempts = 2;
+    test_address(config);
+    test_retry(config, retry_count);
+    test_name(config);
+
+    token.cancel();
+    for (auto i = 0; i < 100 && done == false; ++i)
+        poll_net_tasks(1'000'000); // io_uring: resumed with the cancellation
+    assert(done);
+    unregister_socket(sd);
+    close(sd);
+    return EXIT_SUCCESS;
+}
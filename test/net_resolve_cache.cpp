@@ -0,0 +1,202 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `dns_cache` keeps the answers for their TTL, and the concurrent
+ *         lookups of the same name send only 1 query
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+using message_t = array<uint8_t, 512>;
+
+/**
+ * @return size_t the length of the answer. 0 for no answer
+ */
+size_t make_answer(const message_t& query, message_t& answer,
+                   map<string, uint32_t>& queries) {
+    string name{};
+    size_t pos = 12;
+    while (query[pos]) {
+        if (name.empty() == false)
+            name += '.';
+        name.append(reinterpret_cast<const char*>(&query[pos + 1]),
+                    query[pos]);
+        pos += 1 + query[pos];
+    }
+    pos += 5; // type, class
+    ++queries[name];
+    if (name == "silent.test")
+        return 0;
+
+    memcpy(answer.data(), query.data(), pos);
+    answer[2] = 0x81; // response, recursion desired
+    answer[3] = 0x80; // recursion available
+    answer[6] = answer[7] = 0;
+    if (name == "missing.test") {
+        answer[3] |= 3; // no such name
+        return pos;
+    }
+    const uint8_t ttl = name == "zero.test" ? 0 : 200;
+    const uint8_t record[] = {
+        0xC0, 12,          // name: pointer to the question
+        0,    1,           // type: A
+        0,    1,           // class: IN
+        0,    0, 0, ttl,   // ttl
+        0,    4,           // rdlength
+        127,  0, 0, 7,     // 127.0.0.7
+    };
+    memcpy(&answer[pos], record, sizeof(record));
+    answer[7] = 1;
+    return pos + sizeof(record);
+}
+
+auto serve_stub(int64_t sd, io_cancel_token& token,
+                map<string, uint32_t>& queries, bool& done) -> no_return_t {
+    io_work_t work{};
+    message_t query{}, answer{};
+    const auto forever = steady_clock::now() + hours{1};
+    while (true) {
+        sockaddr_in remote{};
+        io_buffer_t buf{reinterpret_cast<std::byte*>(query.data()),
+                        query.size()};
+        co_await recv_from(sd, remote, buf, work, forever, &token);
+        if (work.error())
+            break;
+        if (const auto len = make_answer(query, answer, queries)) {
+            io_buffer_t reply{reinterpret_cast<std::byte*>(answer.data()),
+                              static_cast<ptrdiff_t>(len)};
+            co_await send_to(sd, remote, reply, work);
+        }
+    }
+    done = true;
+}
+
+uint32_t wait(frame_future<uint32_t>& f) {
+    for (auto i = 0; i < 1000 && f.is_ready() == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(f.is_ready());
+    return f.get();
+}
+
+uint32_t resolve(const dns_config& config, const char* host, const char* serv,
+                 sockaddr_in& output) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    auto f = get_address(config, hint, host, serv,
+                         gsl::span<sockaddr_in>{&output, 1});
+    return wait(f);
+}
+
+void test_coalesced(const dns_config& config, map<string, uint32_t>& queries) {
+    addrinfo hint{};
+    hint.ai_family = AF_INET;
+    array<sockaddr_in, 8> outputs{};
+    vector<frame_future<uint32_t>> futures{};
+    for (auto& output : outputs)
+        futures.emplace_back(get_address(config, hint, "cached.test", "80",
+                                         gsl::span<sockaddr_in>{&output, 1}));
+    for (auto i = 0u; i < futures.size(); ++i) {
+        assert(wait(futures[i]) == 0);
+        assert(outputs[i].sin_addr.s_addr == htonl(0x7F000007));
+        assert(outputs[i].sin_port == htons(80));
+    }
+    assert(queries["cached.test"] == 1);
+    assert(config.cache->size() == 1);
+
+    // the hit is completed without the query
+    sockaddr_in output{};
+    auto hit = get_address(config, hint, "cached.test", "80",
+                           gsl::span<sockaddr_in>{&output, 1});
+    assert(hit.is_ready());
+    assert(hit.get() == 0);
+    assert(output.sin_addr.s_addr == htonl(0x7F000007));
+    assert(queries["cached.test"] == 1);
+
+    // the service is a part of the key
+    assert(resolve(config, "cached.test", "443", output) == 0);
+    assert(output.sin_port == htons(443));
+    assert(queries["cached.test"] == 2);
+}
+
+void test_negative(const dns_config& config, map<string, uint32_t>& queries) {
+    sockaddr_in output{};
+    assert(resolve(config, "missing.test", "80", output) == EAI_NONAME);
+    assert(resolve(config, "missing.test", "80", output) == EAI_NONAME);
+    assert(queries["missing.test"] == 1);
+
+    // no answer and 0 TTL are not cached
+    assert(resolve(config, "silent.test", "80", output) == EAI_AGAIN);
+    assert(resolve(config, "zero.test", "80", output) == 0);
+    assert(resolve(config, "zero.test", "80", output) == 0);
+    assert(queries["zero.test"] == 2);
+}
+
+void test_expiry(const dns_config& config, map<string, uint32_t>& queries) {
+    // `max_ttl` and `negative_ttl` are 1 second
+    this_thread::sleep_for(1100ms);
+    assert(config.cache->size() == 0);
+    sockaddr_in output{};
+    assert(resolve(config, "cached.test", "80", output) == 0);
+    assert(queries["cached.test"] == 3);
+    assert(resolve(config, "missing.test", "80", output) == EAI_NONAME);
+    assert(queries["missing.test"] == 2);
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    const auto sd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(local);
+    assert(bind(sd, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+
+    io_cancel_token token{};
+    map<string, uint32_t> queries{};
+    bool done = false;
+    serve_stub(sd, token, queries, done);
+
+    dns_cache cache{1s, 1s};
+    dns_config config{};
+    config.server = local;
+    config.timeout = 50ms;
+    config.attempts = 1;
+    config.cache = &cache;
+    test_coalesced(config, queries);
+    test_negative(config, queries);
+    test_expiry(config, queries);
+
+    token.cancel();
+    for (auto i = 0; i < 100 && done == false; ++i)
+        poll_net_tasks(1'000'000); // io_uring: resumed with the cancellation
+    assert(done);
+    unregister_socket(sd);
+    close(sd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,199 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Connection setup with `accept` and `connect` awaitables
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr uint32_t client_count = 40;
+
+struct result_t final {
+    bool done = false;
+    int64_t value = 0;
+    uint32_t errc = 0;
+};
+
+auto accept_all(int64_t ln, array<int64_t, client_count>& sockets,
+                result_t& result) -> no_return_t {
+    io_work_t work{};
+    size_t count = 0;
+    while (count < sockets.size()) {
+        gsl::span<int64_t> remain{sockets};
+        auto& op = accept(ln, remain.subspan(count), work);
+        auto n = co_await op;
+        if (n <= 0) {
+            result.errc = work.error();
+            break;
+        }
+        count += static_cast<size_t>(n);
+    }
+    result.value = static_cast<int64_t>(count);
+    result.done = true;
+}
+
+auto accept_one(int64_t ln, result_t& result) -> no_return_t {
+    io_work_t work{};
+    auto& op = accept(ln, work);
+    result.value = co_await op;
+    result.errc = work.error();
+    result.done = true;
+}
+
+auto accept_until(int64_t ln, steady_clock::time_point deadline,
+                  result_t& result) -> no_return_t {
+    io_work_t work{};
+    result.value = co_await accept(ln, work, deadline);
+    result.errc = work.error();
+    result.done = true;
+}
+
+auto connect_to(int64_t sd, const sockaddr_in& remote, result_t& result)
+    -> no_return_t {
+    io_work_t work{};
+    // GCC may copy the awaitable of `co_await connect(...)`.
+    // await the reference so the error is left in `work`
+    auto& op = connect(sd, remote, work);
+    result.value = co_await op;
+    result.errc = work.error();
+    result.done = true;
+}
+
+void poll_until(const result_t& result) {
+    for (auto i = 0; i < 1000 && result.done == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(result.done);
+}
+
+int64_t create_listener(sockaddr_in& local) {
+    const auto ln = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    assert(ln >= 0);
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = 0;
+    socklen_t len = sizeof(local);
+    assert(bind(ln, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    assert(listen(ln, client_count) == 0);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+    return ln;
+}
+
+void close_socket(int64_t sd) {
+    unregister_socket(sd);
+    close(sd);
+}
+
+void test_accept_batch(int64_t ln, const sockaddr_in& local) {
+    array<int64_t, client_count> accepted{};
+    result_t server{};
+    accept_all(ln, accepted, server);
+    assert(server.done == false);
+
+    array<int64_t, client_count> clients{};
+    array<result_t, client_count> connected{};
+    for (auto i = 0u; i < client_count; ++i) {
+        clients[i] = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        connect_to(clients[i], local, connected[i]);
+    }
+    for (auto& result : connected) {
+        poll_until(result);
+        assert(result.errc == 0);
+        assert(result.value == 0);
+    }
+    poll_until(server);
+    assert(server.errc == 0);
+    assert(server.value == client_count);
+
+    // ready for the other awaitables without `fcntl`
+    for (auto sd : accepted) {
+        assert(fcntl(sd, F_GETFL) & O_NONBLOCK);
+        assert(fcntl(sd, F_GETFD) & FD_CLOEXEC);
+        close_socket(sd);
+    }
+    for (auto sd : clients)
+        close_socket(sd);
+}
+
+void test_accept_one(int64_t ln, const sockaddr_in& local) {
+    const auto client = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    result_t connected{};
+    connect_to(client, local, connected);
+    poll_until(connected);
+    assert(connected.errc == 0);
+
+    result_t server{};
+    accept_one(ln, server);
+    poll_until(server);
+    assert(server.errc == 0);
+    assert(server.value >= 0);
+
+    // the connection works in both directions
+    assert(write(client, "ping", 4) == 4);
+    char buf[4]{};
+    for (auto i = 0; i < 1000 && read(server.value, buf, 4) != 4; ++i)
+        poll_net_tasks(1'000'000);
+    assert(buf[0] == 'p' && buf[3] == 'g');
+
+    close_socket(server.value);
+    close_socket(client);
+}
+
+void test_connect_refused() {
+    // bound, but not listening
+    sockaddr_in local{};
+    const auto sd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(local);
+    assert(bind(sd, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+
+    const auto client = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    result_t connected{};
+    connect_to(client, local, connected);
+    poll_until(connected);
+    assert(connected.value == -1);
+    assert(connected.errc == ECONNREFUSED);
+
+    close_socket(client);
+    close(sd);
+}
+
+void test_accept_deadline(int64_t ln) {
+    result_t server{};
+    accept_until(ln, steady_clock::now() + 10ms, server);
+    poll_until(server);
+    assert(server.value == -1);
+    assert(server.errc == ETIMEDOUT);
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    sockaddr_in local{};
+    const auto ln = create_listener(local);
+    test_accept_batch(ln, local);
+    test_accept_one(ln, local);
+    test_accept_deadline(ln);
+    test_accept_one(ln, local); // after the abort
+    test_connect_refused();
+    close_socket(ln);
+    return EXIT_SUCCESS;
+}
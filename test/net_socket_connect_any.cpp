@@ -0,0 +1,183 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `connect_any` doesn't wait for the dead addresses
+ *
+ * The listener with the full backlog drops SYN, so its `connect` hangs
+ * like the backend which is down.
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+
+#include <arpa/inet.h>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+int64_t create_listener(sockaddr_in& local, int backlog) {
+    const auto ln = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    assert(ln >= 0);
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = 0;
+    socklen_t len = sizeof(local);
+    assert(bind(ln, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    if (backlog >= 0)
+        assert(listen(ln, backlog) == 0);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+    return ln;
+}
+
+/**
+ * @brief Fill the backlog. The following SYNs are dropped
+ */
+void fill_backlog(const sockaddr_in& remote, array<int64_t, 4>& clients) {
+    for (auto& sd : clients) {
+        sd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        connect(sd, reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+    }
+    poll_net_tasks(10'000'000); // for the handshakes
+}
+
+uint32_t wait(frame_future<uint32_t>& f) {
+    for (auto i = 0; i < 1000 && f.is_ready() == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(f.is_ready());
+    return f.get();
+}
+
+/**
+ * @return the lowest free descriptor. the losers must be closed
+ */
+int64_t next_descriptor() {
+    const auto sd = socket(AF_INET, SOCK_STREAM, 0);
+    close(sd);
+    return sd;
+}
+
+void test_dead_first(const sockaddr_in& dead, int64_t ln,
+                     const sockaddr_in& alive) {
+    const auto fd = next_descriptor();
+    const array<sockaddr_in, 2> addrs{dead, alive};
+    int64_t sd = -1;
+    const auto start = steady_clock::now();
+    auto f = connect_any({}, addrs, sd, 50ms);
+    assert(wait(f) == 0);
+    const auto elapsed = steady_clock::now() - start;
+    assert(elapsed >= 50ms);
+    assert(elapsed < 1s);
+
+    sockaddr_in remote{};
+    socklen_t len = sizeof(remote);
+    assert(getpeername(sd, reinterpret_cast<sockaddr*>(&remote), &len) == 0);
+    assert(remote.sin_port == alive.sin_port);
+    int64_t accepted = -1;
+    for (auto i = 0; i < 100 && accepted < 0; ++i) {
+        accepted = accept(ln, nullptr, nullptr);
+        poll_net_tasks(1'000'000);
+    }
+    assert(accepted >= 0);
+    close(accepted);
+    unregister_socket(sd);
+    close(sd);
+    assert(next_descriptor() == fd);
+}
+
+void test_refused_first(const sockaddr_in& refused, int64_t ln,
+                        const sockaddr_in& alive) {
+    const array<sockaddr_in, 2> addrs{refused, alive};
+    int64_t sd = -1;
+    const auto start = steady_clock::now();
+    // the next one starts without the delay
+    auto f = connect_any({}, addrs, sd, 10s);
+    assert(wait(f) == 0);
+    assert(steady_clock::now() - start < 1s);
+    assert(sd >= 0);
+    int64_t accepted = -1;
+    for (auto i = 0; i < 100 && accepted < 0; ++i) {
+        accepted = accept(ln, nullptr, nullptr);
+        poll_net_tasks(1'000'000);
+    }
+    assert(accepted >= 0);
+    close(accepted);
+    unregister_socket(sd);
+    close(sd);
+}
+
+void test_all_failed(const sockaddr_in& refused, const sockaddr_in& dead) {
+    const auto fd = next_descriptor();
+    int64_t sd = 0;
+    auto none = connect_any({}, {}, sd);
+    assert(none.get() == EINVAL);
+    assert(sd == -1);
+
+    const array<sockaddr_in, 2> refused_only{refused, refused};
+    auto f1 = connect_any({}, refused_only, sd, 10ms);
+    assert(wait(f1) == ECONNREFUSED);
+    assert(sd == -1);
+
+    const array<sockaddr_in, 2> dead_only{dead, dead};
+    auto f2 = connect_any({}, dead_only, sd, 10ms,
+                          steady_clock::now() + 100ms);
+    assert(wait(f2) == ETIMEDOUT);
+    assert(sd == -1);
+    assert(next_descriptor() == fd);
+}
+
+void test_ip6_first(const sockaddr_in& dead) {
+    const auto ln = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    sockaddr_in6 local{};
+    local.sin6_family = AF_INET6;
+    local.sin6_addr = in6addr_loopback;
+    socklen_t len = sizeof(local);
+    if (bind(ln, reinterpret_cast<sockaddr*>(&local), len) != 0) {
+        close(ln); // no IPv6 loopback
+        return;
+    }
+    assert(listen(ln, 1) == 0);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+
+    int64_t sd = -1;
+    const sockaddr_in6 addrs6[1]{local};
+    const sockaddr_in addrs4[1]{dead};
+    auto f = connect_any(addrs6, addrs4, sd, 1s);
+    assert(wait(f) == 0);
+    sockaddr_in6 remote{};
+    len = sizeof(remote);
+    assert(getpeername(sd, reinterpret_cast<sockaddr*>(&remote), &len) == 0);
+    assert(remote.sin6_family == AF_INET6);
+    unregister_socket(sd);
+    close(sd);
+    close(ln);
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    sockaddr_in dead{}, refused{}, alive{};
+    const auto full = create_listener(dead, 0);
+    array<int64_t, 4> clients{};
+    fill_backlog(dead, clients);
+    const auto closed = create_listener(refused, -1); // bound, not listening
+    const auto ln = create_listener(alive, 8);
+
+    test_dead_first(dead, ln, alive);
+    test_refused_first(refused, ln, alive);
+    test_all_failed(refused, dead);
+    test_ip6_first(dead);
+
+    for (auto sd : clients)
+        close(sd);
+    close(full);
+    close(closed);
+    close(ln);
+    return EXIT_SUCCESS;
+}
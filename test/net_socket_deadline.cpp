@@ -0,0 +1,194 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Pending I/O works are aborted with the deadline or the token
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+using io_buffer_reserved_t = array<std::byte, 64>;
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+struct io_result final {
+    bool done = false;
+    int64_t size = 0;
+    uint32_t errc = 0;
+};
+
+auto recv_until(int64_t sd, steady_clock::time_point deadline,
+                io_cancel_token* token, io_result& result) -> no_return_t {
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    result.size = co_await recv_stream(sd, storage, 0, work, deadline, token);
+    result.errc = work.error();
+    result.done = true;
+}
+
+auto recv_then_reset(int64_t sd, unique_ptr<io_cancel_token>& token,
+                     io_result& result) -> no_return_t {
+    io_work_t work{};
+    io_buffer_reserved_t storage{};
+    result.size = co_await recv_stream(
+        sd, storage, 0, work, steady_clock::time_point::max(), token.get());
+    result.errc = work.error();
+    result.done = true;
+    token.reset(); // the other one may be still in `cancel`
+}
+
+auto cancel_later(milliseconds duration, io_cancel_token& token)
+    -> no_return_t {
+    co_await sleep_for(duration);
+    token.cancel();
+}
+
+void poll_until(const io_result& result) {
+    const auto until = steady_clock::now() + 5s;
+    while (result.done == false && steady_clock::now() < until)
+        poll_net_tasks(10'000'000);
+    assert(result.done);
+}
+
+void test_deadline(int64_t sd) {
+    io_result result{};
+    const auto start = steady_clock::now();
+    recv_until(sd, start + 50ms, nullptr, result);
+    assert(result.done == false);
+    poll_until(result);
+    assert(steady_clock::now() - start >= 50ms);
+    assert(result.size == -1);
+    assert(result.errc == ETIMEDOUT);
+}
+
+void test_cancel(int64_t sd) {
+    io_cancel_token token{};
+    io_result result{};
+    recv_until(sd, steady_clock::time_point::max(), &token, result);
+    cancel_later(20ms, token);
+    poll_until(result);
+    assert(result.size == -1);
+    assert(result.errc == ECANCELED);
+
+    // the cancelled token fails the work immediately
+    io_result again{};
+    recv_until(sd, steady_clock::time_point::max(), &token, again);
+    assert(again.done);
+    assert(again.errc == ECANCELED);
+}
+
+void test_cancel_destroy(int64_t sd1, int64_t sd2) {
+    auto token = make_unique<io_cancel_token>();
+    io_result result1{}, result2{};
+    recv_then_reset(sd1, token, result1);
+    recv_then_reset(sd2, token, result2);
+    token->cancel();
+    poll_until(result1);
+    poll_until(result2);
+    assert(result1.errc == ECANCELED);
+    assert(result2.errc == ECANCELED);
+    assert(token == nullptr);
+}
+
+void test_token_gone(int64_t sd, int64_t peer) {
+    io_result result{};
+    {
+        io_cancel_token token{};
+        recv_until(sd, steady_clock::time_point::max(), &token, result);
+    } // the work continues without the token
+    const char message[] = "token";
+    assert(write(peer, message, sizeof(message)) == sizeof(message));
+    poll_until(result);
+    assert(result.size == sizeof(message));
+}
+
+// the descriptors are reused without `unregister_socket`
+void test_reused_descriptor(int (&sv)[2]) {
+    const int prev[2]{sv[0], sv[1]};
+    close(sv[0]);
+    close(sv[1]);
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    assert(sv[0] == prev[0] && sv[1] == prev[1]);
+    const char message[] = "reused";
+    io_result result{};
+    recv_until(sv[0], steady_clock::now() + 2s, nullptr, result);
+    assert(result.done == false);
+    assert(write(sv[1], message, sizeof(message)) == sizeof(message));
+    poll_until(result);
+    assert(result.size == sizeof(message));
+
+    // the blocking socket completes without suspension, then it is closed
+    // without `unregister_socket`. the next socket is non-blocking
+    close(sv[0]);
+    close(sv[1]);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    assert(sv[0] == prev[0] && sv[1] == prev[1]);
+    assert(write(sv[1], message, sizeof(message)) == sizeof(message));
+    result = io_result{};
+    recv_until(sv[0], steady_clock::now() + 2s, nullptr, result);
+    assert(result.done && result.size == sizeof(message));
+    close(sv[0]);
+    close(sv[1]);
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    assert(sv[0] == prev[0] && sv[1] == prev[1]);
+    result = io_result{};
+    recv_until(sv[0], steady_clock::now() + 2s, nullptr, result);
+    assert(result.done == false);
+    assert(write(sv[1], message, sizeof(message)) == sizeof(message));
+    poll_until(result);
+    assert(result.size == sizeof(message));
+}
+
+void test_completion(int64_t sd, int64_t peer) {
+    io_cancel_token token{};
+    io_result result{};
+    recv_until(sd, steady_clock::now() + 100ms, &token, result);
+    const char message[] = "deadline";
+    assert(write(peer, message, sizeof(message)) == sizeof(message));
+    poll_until(result);
+    assert(result.size == sizeof(message));
+    assert(result.errc == 0);
+
+    // the timer was cancelled. nothing happens after the deadline
+    const auto until = steady_clock::now() + 150ms;
+    while (steady_clock::now() < until)
+        poll_net_tasks(10'000'000);
+    token.cancel();
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    int sv[2]{}, sv2[2]{};
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv2) == 0);
+
+    test_deadline(sv[0]);
+    test_cancel(sv[0]);
+    test_cancel_destroy(sv[0], sv2[0]);
+    test_token_gone(sv[0], sv[1]);
+    test_reused_descriptor(sv2);
+    test_completion(sv[0], sv[1]);
+
+    unregister_socket(sv[0]);
+    unregister_socket(sv2[0]);
+    close(sv[0]);
+    close(sv[1]);
+    close(sv2[0]);
+    close(sv2[1]);
+    return EXIT_SUCCESS;
+}
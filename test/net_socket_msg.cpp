@@ -0,0 +1,136 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Multi-part message and ancillary data with `send_msg`/`recv_msg`
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+struct header_t final {
+    uint32_t kind;
+    uint32_t length;
+};
+
+struct received_t final {
+    bool done = false;
+    int64_t size = 0;
+    header_t header{};
+    array<char, 32> body{};
+    int fd = -1; // from `SCM_RIGHTS`
+};
+
+auto recv_parts(int64_t sd, received_t& result) -> no_return_t {
+    io_work_t work{};
+    iovec parts[2]{};
+    parts[0].iov_base = &result.header;
+    parts[0].iov_len = sizeof(header_t);
+    parts[1].iov_base = result.body.data();
+    parts[1].iov_len = result.body.size();
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = parts;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    result.size = co_await recv_msg(sd, msg, 0, work);
+    assert(work.error() == 0);
+    assert((msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) == 0);
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+            memcpy(&result.fd, CMSG_DATA(cmsg), sizeof(int));
+    result.done = true;
+}
+
+auto send_parts(int64_t sd, string_view body, int fd, int64_t& sent)
+    -> no_return_t {
+    io_work_t work{};
+    header_t header{7, static_cast<uint32_t>(body.size())};
+    iovec parts[2]{};
+    parts[0].iov_base = &header;
+    parts[0].iov_len = sizeof(header_t);
+    parts[1].iov_base = const_cast<char*>(body.data());
+    parts[1].iov_len = body.size();
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = parts;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    sent = co_await send_msg(sd, msg, MSG_NOSIGNAL, work);
+    assert(work.error() == 0);
+}
+
+void poll_until(const received_t& result) {
+    for (auto i = 0; i < 1000 && result.done == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(result.done);
+}
+
+void test_multipart(int64_t sd, int64_t peer) {
+    int pipes[2]{};
+    assert(pipe(pipes) == 0);
+    constexpr string_view body = "scatter/gather";
+
+    // the receiver suspends first, then 1 `sendmsg` resumes it
+    received_t result{};
+    recv_parts(sd, result);
+    assert(result.done == false);
+    int64_t sent = 0;
+    send_parts(peer, body, pipes[1], sent);
+    poll_until(result);
+    poll_net_tasks(0); // io_uring: the sender may be completed later
+    assert(sent == sizeof(header_t) + body.size());
+    assert(result.size == sent);
+    assert(result.header.kind == 7);
+    assert(result.header.length == body.size());
+    assert(string_view(result.body.data(), body.size()) == body);
+
+    // the descriptor is passed with the ancillary data
+    assert(result.fd >= 0 && result.fd != pipes[1]);
+    assert(write(result.fd, "!", 1) == 1);
+    char c{};
+    assert(read(pipes[0], &c, 1) == 1 && c == '!');
+    close(result.fd);
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    int sv[2]{};
+    assert(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, sv) == 0);
+
+    test_multipart(sv[0], sv[1]);
+    test_multipart(sv[0], sv[1]);
+
+    unregister_socket(sv[0]);
+    unregister_socket(sv[1]);
+    close(sv[0]);
+    close(sv[1]);
+    return EXIT_SUCCESS;
+}
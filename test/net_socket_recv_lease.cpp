@@ -0,0 +1,119 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Waiting `recv_lease` holds no buffer. It is leased on readiness
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr size_t connection_count = 100;
+
+auto echo_service(int64_t sd, io_buffer_pool& pool, uint32_t& running)
+    -> no_return_t {
+    io_work_t work{};
+    io_lease lease{pool}; // no storage in the frame
+    while (true) {
+        auto rsz = co_await recv_lease(sd, lease, 4000, 0, work);
+        if (rsz <= 0)
+            break;
+        assert(lease.buffer.size() == rsz);
+        io_buffer_t buf = lease.buffer;
+        while (buf.empty() == false) {
+            auto ssz = co_await send_stream(sd, buf, 0, work);
+            if (ssz <= 0)
+                goto OnError;
+            buf = buf.subspan(ssz);
+        }
+        lease.release();
+    }
+OnError:
+    --running;
+}
+
+void test_pool() {
+    io_buffer_pool pool{};
+    auto first = pool.acquire(1000);
+    assert(first.size() == 1024);
+    assert(pool.leased() == 1);
+    pool.release(first.first(10)); // the received part is enough
+    assert(pool.leased() == 0);
+
+    // reused from the free list of the class
+    auto second = pool.acquire(600);
+    assert(second.data() == first.data());
+    pool.release(second);
+    auto small = pool.acquire(1);
+    assert(small.size() == io_buffer_pool::min_size);
+    pool.release(small);
+
+    try {
+        pool.acquire(io_buffer_pool::max_size + 1);
+        assert(false);
+    } catch (const system_error& e) {
+        assert(e.code().value() == EINVAL);
+    }
+}
+
+void test_idle_connections() {
+    io_buffer_pool pool{};
+    array<int64_t, connection_count> services{}, peers{};
+    uint32_t running = connection_count;
+    for (auto i = 0u; i < connection_count; ++i) {
+        int sv[2]{};
+        assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+        services[i] = sv[0];
+        peers[i] = sv[1];
+        echo_service(services[i], pool, running);
+    }
+    poll_net_tasks(0);
+    assert(pool.leased() == 0); // all of them are waiting
+
+    for (auto i = 0u; i < connection_count; i += 10) {
+        const char message[] = "lease";
+        assert(write(peers[i], message, sizeof(message)) == sizeof(message));
+        char echo[sizeof(message)]{};
+        for (auto n = 0; n < 1000; ++n) {
+            poll_net_tasks(1'000'000);
+            if (read(peers[i], echo, sizeof(echo)) == sizeof(echo))
+                break;
+        }
+        assert(memcmp(echo, message, sizeof(message)) == 0);
+        poll_net_tasks(0);
+        assert(pool.leased() == 0); // returned after the echo
+    }
+
+    for (auto sd : peers)
+        close(sd); // EOF
+    for (auto n = 0; n < 1000 && running; ++n)
+        poll_net_tasks(1'000'000);
+    assert(running == 0);
+    assert(pool.leased() == 0);
+    for (auto sd : services) {
+        unregister_socket(sd);
+        close(sd);
+    }
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    test_pool();
+    test_idle_connections();
+    return EXIT_SUCCESS;
+}
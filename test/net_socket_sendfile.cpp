@@ -0,0 +1,131 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  Stream a file to the socket with `send_file` and `splice_file`
+ */
+#undef NDEBUG
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr size_t file_size = 8 * 1024 * 1024 + 123;
+constexpr size_t chunk_size = 256 * 1024;
+
+auto stream_with_sendfile(int64_t sd, int64_t fd, bool& done)
+    -> no_return_t {
+    io_work_t work{};
+    int64_t offset = 0;
+    while (static_cast<size_t>(offset) < file_size) {
+        const auto remain = file_size - static_cast<size_t>(offset);
+        auto sz = co_await send_file(sd, fd, offset, min(remain, chunk_size),
+                                     work);
+        assert(work.error() == 0);
+        assert(sz > 0);
+    }
+    done = true;
+}
+
+auto stream_with_splice(int64_t sd, int64_t fd, bool& done) -> no_return_t {
+    io_work_t work{};
+    io_pipe pipe{};
+    int64_t offset = 0;
+    size_t sent = 0;
+    while (sent < file_size) {
+        auto sz = co_await splice_file(sd, fd, offset, chunk_size, pipe, work);
+        assert(work.error() == 0);
+        assert(sz > 0);
+        sent += static_cast<size_t>(sz);
+    }
+    assert(offset == static_cast<int64_t>(file_size));
+    assert(pipe.pending == 0);
+    done = true;
+}
+
+auto recv_all(int64_t sd, vector<std::byte>& storage, bool& done)
+    -> no_return_t {
+    io_work_t work{};
+    size_t received = 0;
+    while (received < storage.size()) {
+        auto sz = co_await recv_stream(
+            sd, io_buffer_t{storage}.subspan(received), 0, work);
+        assert(sz > 0);
+        received += static_cast<size_t>(sz);
+    }
+    done = true;
+}
+
+int64_t create_file() {
+    char path[] = "/tmp/coroutine_net_sendfile_XXXXXX";
+    const auto fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+    vector<std::byte> content(file_size);
+    for (auto i = 0u; i < file_size; ++i)
+        content[i] = static_cast<std::byte>(i % 253);
+    assert(write(fd, content.data(), file_size) ==
+           static_cast<ssize_t>(file_size));
+    return fd;
+}
+
+void connect_pair(int64_t& server, int64_t& client) {
+    const auto ln = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(local);
+    assert(bind(ln, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    assert(listen(ln, 1) == 0);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    assert(connect(client, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    server = accept4(ln, nullptr, nullptr, SOCK_NONBLOCK);
+    assert(server >= 0);
+    fcntl(client, F_SETFL, O_NONBLOCK);
+    close(ln);
+}
+
+template <typename Streamer>
+void test_stream(int64_t fd, Streamer&& stream) {
+    int64_t server = -1, client = -1;
+    connect_pair(server, client);
+
+    vector<std::byte> storage(file_size);
+    bool sent = false, received = false;
+    recv_all(client, storage, received);
+    stream(server, fd, sent);
+    for (auto i = 0; i < 10'000 && (sent == false || received == false); ++i)
+        poll_net_tasks(10'000'000);
+    assert(sent && received);
+    for (auto i = 0u; i < file_size; ++i)
+        assert(storage[i] == static_cast<std::byte>(i % 253));
+
+    for (auto sd : {server, client}) {
+        unregister_socket(sd);
+        close(sd);
+    }
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    const auto fd = create_file();
+    test_stream(fd, stream_with_sendfile);
+    test_stream(fd, stream_with_splice);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -154,6 +154,10 @@ auto tcp_send_stream(uint64_t sd, io_work_t& work, //
 int main(int, char*[]) {
     socket_setup();
     auto on_return = gsl::finally([]() { socket_teardown(); });
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
 
     // going to handle 4 connections concurrently
     static constexpr auto max_socket_count = 4U;
@@ -181,8 +185,10 @@ int main(int, char*[]) {
     sockaddr_in local{}; // local: listening address
     local.sin_family = hint.ai_family;
     local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-    local.sin_port = htons(3345);
+    local.sin_port = 0; // let system define the port. see `getsockname`
     socket_bind(ln, local);
+    socklen_t len = sizeof(local);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
 
     socket_set_option(ln, SOL_SOCKET, SO_REUSEADDR, true);
     socket_set_option_nonblock(ln);
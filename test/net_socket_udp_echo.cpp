@@ -110,6 +110,10 @@ OnError:
 int main(int, char*[]) {
     socket_setup();
     auto on_return = gsl::finally([]() { socket_teardown(); });
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
 
     static constexpr auto max_socket_count = 4;
     static constexpr auto io_coroutine_count = max_socket_count * 2;
@@ -137,8 +141,11 @@ int main(int, char*[]) {
     sockaddr_in local{};
     local.sin_family = hint.ai_family;
     local.sin_addr.s_addr = htonl(INADDR_ANY);
-    local.sin_port = htons(32771);
+    local.sin_port = 0; // let system define the port. see `getsockname`
     socket_bind(ss, local);
+    sockaddr_in service{};
+    socklen_t len = sizeof(service);
+    getsockname(ss, reinterpret_cast<sockaddr*>(&service), &len);
     socket_set_option_nonblock(ss);
 
     // spawn echo coroutine
@@ -167,7 +174,7 @@ int main(int, char*[]) {
     // We should know where to send packets. Reuse the memory object
     sockaddr_in& remote = local;
     remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-    remote.sin_port = htons(32771);
+    remote.sin_port = service.sin_port;
 
     // We will spawn some coroutines and wait them to return using `latch`.
     // Those coroutines will perform send/recv operation on the socket
@@ -0,0 +1,151 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  1 buffer is sent as many datagrams with `UDP_SEGMENT`,
+ *         and received as 1 buffer with `UDP_GRO`
+ */
+#undef NDEBUG
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr uint16_t segment_size = 1000;
+constexpr size_t segment_count = 8;
+constexpr size_t total_size = segment_size * (segment_count - 1) + 500;
+
+struct result_t final {
+    bool done = false;
+    int64_t size = 0;
+    uint32_t errc = 0;
+    uint16_t segment = 0;
+};
+
+auto send_all(int64_t sd, const sockaddr_in& remote, io_buffer_t buf,
+              result_t& result) -> no_return_t {
+    io_work_t work{};
+    io_segment_msg msg{};
+    result.size =
+        co_await send_segments(sd, remote, buf, segment_size, msg, work);
+    result.errc = work.error();
+    result.done = true;
+}
+
+auto recv_all(int64_t sd, io_buffer_t buf, result_t& result) -> no_return_t {
+    io_work_t work{};
+    io_segment_msg msg{};
+    sockaddr_in remote{};
+    result.size = co_await recv_segments(sd, remote, buf, msg, work);
+    result.errc = work.error();
+    result.segment = get_segment_size(msg);
+    result.done = true;
+}
+
+int64_t create_udp(sockaddr_in& local) {
+    const auto sd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    assert(sd >= 0);
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = 0;
+    assert(bind(sd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == 0);
+    socklen_t len = sizeof(local);
+    getsockname(sd, reinterpret_cast<sockaddr*>(&local), &len);
+    return sd;
+}
+
+void poll_until(const result_t& result) {
+    for (auto i = 0; i < 1000 && result.done == false; ++i)
+        poll_net_tasks(10'000'000);
+    assert(result.done);
+}
+
+/**
+ * @return false GSO is not supported. nothing to test
+ */
+bool test_coalesced(int64_t sender, int64_t receiver,
+                    const sockaddr_in& remote) {
+    vector<std::byte> message(total_size);
+    for (auto i = 0u; i < message.size(); ++i)
+        message[i] = static_cast<std::byte>(i / segment_size);
+    vector<std::byte> storage(64 * 1024);
+
+    result_t received{};
+    recv_all(receiver, storage, received);
+    assert(received.done == false);
+
+    result_t sent{};
+    send_all(sender, remote, message, sent);
+    poll_until(sent);
+    if (sent.errc == EIO || sent.errc == EINVAL) {
+        fprintf(stderr, "UDP_SEGMENT is not supported: %u\n", sent.errc);
+        return false;
+    }
+    assert(sent.errc == 0);
+    assert(sent.size == static_cast<int64_t>(total_size));
+
+    // 1 suspension for the whole buffer
+    poll_until(received);
+    assert(received.errc == 0);
+    assert(received.size == static_cast<int64_t>(total_size));
+    assert(received.segment == segment_size);
+    for (auto i = 0u; i < total_size; ++i)
+        assert(storage[i] == message[i]);
+    return true;
+}
+
+void test_segmented(int64_t sender, int64_t receiver,
+                    const sockaddr_in& remote) {
+    vector<std::byte> message(total_size);
+    vector<std::byte> storage(64 * 1024);
+    result_t sent{};
+    send_all(sender, remote, message, sent);
+    poll_until(sent);
+    assert(sent.size == static_cast<int64_t>(total_size));
+
+    // without GRO, each of them is a datagram
+    for (auto i = 0u; i < segment_count; ++i) {
+        result_t received{};
+        recv_all(receiver, storage, received);
+        poll_until(received);
+        assert(received.segment == 0);
+        const auto expected = i + 1 < segment_count ? segment_size : 500;
+        assert(received.size == expected);
+    }
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    sockaddr_in local{}, remote{};
+    const auto sender = create_udp(local);
+    const auto receiver = create_udp(remote);
+    try {
+        set_udp_gro(receiver, true);
+    } catch (const system_error& e) {
+        fputs(e.what(), stderr);
+        return EXIT_SUCCESS; // not supported. nothing to test
+    }
+    if (test_coalesced(sender, receiver, remote)) {
+        set_udp_gro(receiver, false);
+        test_segmented(sender, receiver, remote);
+    }
+    for (auto sd : {sender, receiver}) {
+        unregister_socket(sd);
+        close(sd);
+    }
+    return EXIT_SUCCESS;
+}
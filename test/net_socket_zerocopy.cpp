@@ -0,0 +1,115 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `send_zerocopy` resumes after the buffer is released,
+ *         and falls back to the copy for the small buffer/unsupported socket
+ */
+#undef NDEBUG
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+constexpr size_t message_size = 4 * 1024 * 1024;
+
+auto send_all(int64_t sd, vector<std::byte>& message, bool& done)
+    -> no_return_t {
+    io_work_t work{};
+    size_t sent = 0;
+    while (sent < message.size()) {
+        auto sz = co_await send_zerocopy(
+            sd, io_buffer_t{message}.subspan(sent), 0, work);
+        assert(work.error() == 0);
+        assert(sz > 0);
+        // released. the next part can be prepared in this buffer
+        for (auto i = 0; i < sz; ++i)
+            message[sent + i] = std::byte{0xFF};
+        sent += static_cast<size_t>(sz);
+    }
+    done = true;
+}
+
+auto recv_all(int64_t sd, vector<std::byte>& storage, bool& done)
+    -> no_return_t {
+    io_work_t work{};
+    size_t received = 0;
+    while (received < storage.size()) {
+        auto sz = co_await recv_stream(
+            sd, io_buffer_t{storage}.subspan(received), 0, work);
+        assert(sz > 0);
+        received += static_cast<size_t>(sz);
+    }
+    done = true;
+}
+
+void test_transfer(int64_t sender, int64_t receiver, size_t size) {
+    vector<std::byte> message(size), storage(size);
+    for (auto i = 0u; i < size; ++i)
+        message[i] = static_cast<std::byte>(i % 251);
+
+    bool sent = false, received = false;
+    recv_all(receiver, storage, received);
+    send_all(sender, message, sent);
+    for (auto i = 0; i < 10'000 && (sent == false || received == false); ++i)
+        poll_net_tasks(10'000'000);
+    assert(sent && received);
+    // the changes after the resumption are not sent
+    for (auto i = 0u; i < size; ++i)
+        assert(storage[i] == static_cast<std::byte>(i % 251));
+}
+
+void test_tcp() {
+    const auto ln = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(local);
+    assert(bind(ln, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    assert(listen(ln, 1) == 0);
+    getsockname(ln, reinterpret_cast<sockaddr*>(&local), &len);
+
+    const auto client = socket(AF_INET, SOCK_STREAM, 0);
+    assert(connect(client, reinterpret_cast<sockaddr*>(&local), len) == 0);
+    const auto server = accept4(ln, nullptr, nullptr, SOCK_NONBLOCK);
+    assert(server >= 0);
+    fcntl(client, F_SETFL, O_NONBLOCK);
+
+    test_transfer(server, client, message_size);
+    test_transfer(server, client, 100); // copied
+
+    for (auto sd : {server, client}) {
+        unregister_socket(sd);
+        close(sd);
+    }
+    close(ln);
+}
+
+void test_unsupported() {
+    int sv[2]{};
+    assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    test_transfer(sv[0], sv[1], message_size);
+    for (auto sd : sv) {
+        unregister_socket(sd);
+        close(sd);
+    }
+}
+
+int main(int, char*[]) {
+#if defined(TEST_IO_URING)
+    if (select_io_backend(io_backend::io_uring) == false)
+        return EXIT_SUCCESS; // not supported. nothing to test
+#endif
+    test_tcp();
+    test_unsupported();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief  `sleep_for`/`sleep_until` with the timer wheel of `poll_net_tasks`
+ */
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include <coroutine/net.h>
+#include <coroutine/return.h>
+
+using namespace std;
+using namespace std::chrono;
+using namespace coro;
+
+#if defined(__GNUC__)
+using no_return_t = coro::null_frame_t;
+#else
+using no_return_t = std::nullptr_t;
+#endif
+
+auto sleep_and_record(milliseconds duration, vector<int>& order, int id)
+    -> no_return_t {
+    const auto start = steady_clock::now();
+    co_await sleep_for(duration);
+    assert(steady_clock::now() - start >= duration);
+    order.push_back(id);
+}
+
+auto sleep_and_count(steady_clock::time_point tp, size_t& count)
+    -> no_return_t {
+    co_await sleep_until(tp);
+    assert(steady_clock::now() >= tp);
+    ++count;
+}
+
+auto sleep_cancelled(milliseconds duration, bool& resumed) -> frame_t {
+    co_await sleep_for(duration);
+    resumed = true;
+}
+
+void test_order() {
+    vector<int> order{};
+    sleep_and_record(30ms, order, 3);
+    sleep_and_record(10ms, order, 1);
+    sleep_and_record(300ms, order, 4); // placed in the upper level
+    sleep_and_record(20ms, order, 2);
+    sleep_and_record(0ms, order, 0); // doesn't suspend
+    assert(order.size() == 1);
+
+    const auto start = steady_clock::now();
+    while (order.size() < 5)
+        poll_net_tasks(100'000'000);
+    // the wait was shortened for the timers
+    assert(steady_clock::now() - start < 2s);
+    assert((order == vector<int>{0, 1, 2, 3, 4}));
+}
+
+void test_cancel() {
+    bool resumed = false;
+    auto frame = sleep_cancelled(10ms, resumed);
+    frame.destroy(); // the destructor of the awaiter cancels the timer
+
+    const auto until = steady_clock::now() + 50ms;
+    while (steady_clock::now() < until)
+        poll_net_tasks(10'000'000);
+    assert(resumed == false);
+}
+
+void test_many_timers() {
+    constexpr size_t timer_count = 100'000;
+    const auto start = steady_clock::now();
+    size_t count = 0;
+    for (auto i = 0u; i < timer_count; ++i)
+        sleep_and_count(start + milliseconds{i % 700}, count);
+
+    while (count < timer_count)
+        poll_net_tasks(10'000'000);
+    assert(steady_clock::now() - start < 5s);
+}
+
+int main(int, char*[]) {
+    test_order();
+    test_cancel();
+    test_many_timers();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+
+#include <coroutine/pthread.h>
+#include <coroutine/return.h>
+
+using namespace coro;
+using namespace std;
+
+auto run_pooled(pthread_t& self, const pthread_attr_t* attr)
+    -> pthread_joiner {
+    co_await pthread_pooled{attr};
+    self = pthread_self();
+}
+
+auto run_pooled_detached(atomic<pthread_t>& self, const pthread_attr_t* attr)
+    -> pthread_detacher {
+    co_await pthread_pooled{attr};
+    self = pthread_self();
+}
+
+int main(int, char*[]) {
+    pthread_t t1{}, t2{}, t3{};
+    {
+        auto join = run_pooled(t1, nullptr);
+        assert(pthread_t{join} != pthread_t{});
+    }
+    assert(t1 != pthread_t{});
+    assert(pthread_equal(t1, pthread_self()) == 0);
+    // the parked thread must be reused
+    {
+        auto join = run_pooled(t2, nullptr);
+    }
+    assert(pthread_equal(t1, t2));
+
+    // different attributes. another thread is required
+    pthread_attr_t attr{};
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 4 * 1024 * 1024);
+    {
+        auto join = run_pooled(t3, &attr);
+    }
+    assert(pthread_equal(t1, t3) == 0);
+    {
+        auto join = run_pooled(t2, &attr);
+    }
+    assert(pthread_equal(t2, t3));
+    pthread_attr_destroy(&attr);
+
+    // the detached one can be reused too
+    atomic<pthread_t> t4{};
+    run_pooled_detached(t4, nullptr);
+    while (t4 == pthread_t{})
+        sched_yield();
+    assert(pthread_equal(t1, t4));
+    return EXIT_SUCCESS;
+}
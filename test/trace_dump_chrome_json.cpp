@@ -0,0 +1,94 @@
+/**
+ * @author github.com/luncliff (luncliff@gmail.com)
+ */
+#undef NDEBUG
+#define USE_COROUTINE_TRACE
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <coroutine/return.h>
+#include <coroutine/trace.h>
+
+using namespace std;
+using namespace coro;
+
+auto suspend_once() -> frame_t {
+    co_await suspend_always{};
+}
+
+auto read_all(FILE* stream) -> string {
+    string text{};
+    char buf[512]{};
+    rewind(stream);
+    while (auto sz = fread(buf, 1, sizeof(buf), stream))
+        text.append(buf, sz);
+    return text;
+}
+
+int main(int, char*[]) {
+    trace_clear();
+
+    // create in this thread, resume(finish) in another thread
+    auto frame = suspend_once();
+    char address[32]{};
+    snprintf(address, sizeof(address), "\"address\":\"%p\"", frame.address());
+    thread worker{[frame]() { frame.resume(); }};
+    worker.join();
+    assert(frame.done());
+    frame.destroy();
+
+    FILE* stream = tmpfile();
+    assert(stream != nullptr);
+    const auto count = trace_dump(stream);
+    const auto text = read_all(stream);
+    fclose(stream);
+
+    // `initial_suspend` + `final_suspend` at least
+    assert(count >= 2);
+    assert(text.find("{\"traceEvents\":[") == 0);
+    assert(text.find("\"name\":\"create\"") != string::npos);
+    assert(text.find("\"name\":\"final\"") != string::npos);
+    // the promise records the frame address like `coroutine_handle`
+    for (const auto* name : {"\"name\":\"create\"", "\"name\":\"final\""}) {
+        const auto pos = text.find(name);
+        assert(text.find(address, pos) < text.find('\n', pos));
+    }
+    if (trace_is_enabled()) {
+        assert(text.find("\"ph\":\"B\"") != string::npos);
+        assert(text.find("\"ph\":\"E\"") != string::npos);
+        assert(text.find("\"name\":\"destroy\"") != string::npos);
+    }
+    // the events were recorded in 2 threads
+    const auto tid1 = text.find("\"tid\":");
+    const auto tid2 = text.rfind("\"tid\":");
+    assert(tid1 != tid2);
+    assert(text.compare(tid1, 16, text, tid2, 16) != 0);
+
+    // cleared buffers are empty
+    trace_clear();
+    stream = tmpfile();
+    assert(trace_dump(stream) == 0);
+    fclose(stream);
+
+    // dump while the other thread wraps its ring
+    atomic_bool stop{false};
+    thread writer{[&stop]() {
+        size_t n = 0;
+        while (stop.load() == false || n < 100'000)
+            trace_record(trace_kind::create, &stop), ++n;
+    }};
+    for (auto i = 0; i < 4; ++i) {
+        stream = tmpfile();
+        trace_dump(stream);
+        const auto partial = read_all(stream);
+        fclose(stream);
+        assert(partial.find("\"name\":\"unknown\"") == string::npos);
+        this_thread::yield();
+    }
+    stop = true;
+    writer.join();
+    return 0;
+}